@@ -0,0 +1,52 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Chooses the tessellation levels of a quintic Bezier triangle from the projected length of its edges.  The level of an edge only depends on the two corners it connects so that neighboring patches agree on it and the surface has no cracks.  The control points are expected in the space the vertex shader outputs (view space); the projection matrix of the frame maps them to clip space.
+
+#version 430 core
+
+layout(vertices = 21) out;
+
+layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+
+uniform float maxLevel = 64.0;
+uniform float tolerance;//edge length in pixels of a tessellated triangle
+
+const int CORNERS[3] = int[3](0, 5, 20);//rows of 6, 5, 4, 3, 2, 1 control points
+
+float level(vec4 a, vec4 b) {
+     if(a.w <= 0.0 || b.w <= 0.0) return maxLevel;//NOTE: Edges that cross the eye plane cannot be projected.
+     vec2 d = 0.5 * viewportSize * (a.xy / a.w - b.xy / b.w);
+     return clamp(length(d) / tolerance, 1.0, maxLevel);
+}
+
+bool isOutside(vec4 p, int axis, float side) { return side * p[axis] > p.w; }
+
+void main() {
+     gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+     if(gl_InvocationID != 0) return;
+
+     vec4 points[21];
+     for(int i = 0; i < 21; ++i) points[i] = projectionMatrix * gl_in[i].gl_Position;
+
+     //NOTE: By the convex hull property, a patch whose control points all lie outside of one frustum plane is invisible.
+     for(int axis = 0; axis < 3; ++axis) for(int side = -1; side <= 1; side += 2) {
+          bool outside = true;
+          for(int i = 0; i < 21 && outside; ++i) outside = isOutside(points[i], axis, float(side));
+          if(outside) {
+               gl_TessLevelOuter[0] = gl_TessLevelOuter[1] = gl_TessLevelOuter[2] = gl_TessLevelInner[0] = 0.0;
+               return;
+          }
+     }
+
+     vec4 c0 = points[CORNERS[0]];
+     vec4 c1 = points[CORNERS[1]];
+     vec4 c2 = points[CORNERS[2]];
+     gl_TessLevelOuter[0] = level(c1, c2);
+     gl_TessLevelOuter[1] = level(c2, c0);
+     gl_TessLevelOuter[2] = level(c0, c1);
+     gl_TessLevelInner[0] = max(gl_TessLevelOuter[0], max(gl_TessLevelOuter[1], gl_TessLevelOuter[2]));
+}
+
@@ -0,0 +1,307 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#include "Bvh.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+static constexpr hpuint BVH_BINS = 16;
+static constexpr hpuint BVH_MAX_LEAF_SIZE = 8;
+
+struct BvhBox {
+     Point3D lower = Point3D(std::numeric_limits<hpreal>::max());
+     Point3D upper = Point3D(-std::numeric_limits<hpreal>::max());
+
+     void extend(const Point3D& point) {
+          lower = glm::min(lower, point);
+          upper = glm::max(upper, point);
+     }
+
+     void extend(const BvhBox& box) {
+          lower = glm::min(lower, box.lower);
+          upper = glm::max(upper, box.upper);
+     }
+
+     hpreal getArea() const {
+          auto d = glm::max(upper - lower, Vector3D(0));
+          return d.x * d.y + d.y * d.z + d.z * d.x;
+     }
+
+};//BvhBox
+
+//NOTE: The bounds and centroids of the triangles, which the build reads instead of the mesh.
+struct BvhInput {
+     std::vector<BvhBox> boxes;
+     std::vector<Point3D> centroids;
+     std::vector<hpuint> triangles;
+
+};//BvhInput
+
+//NOTE: Returns the position at which the triangles from first to last are partitioned into two children, or first if they should be a leaf.
+static hpuint split(BvhInput& input, hpuint first, hpuint last, BvhBox& bounds) {
+     auto centroids = BvhBox();
+     for(auto i = first; i < last; ++i) {
+          auto t = input.triangles[i];
+          bounds.extend(input.boxes[t]);
+          centroids.extend(input.centroids[t]);
+     }
+     auto n = last - first;
+     if(n <= 2) return first;
+
+     auto extent = centroids.upper - centroids.lower;
+     auto bestAxis = 0;
+     auto bestBin = hpuint(0);
+     auto bestCost = std::numeric_limits<hpreal>::max();
+     for(auto axis = 0; axis < 3; ++axis) {
+          if(extent[axis] <= 0) continue;
+          auto scale = hpreal(BVH_BINS) / extent[axis];
+          auto boxes = std::array<BvhBox, BVH_BINS>();
+          auto counts = std::array<hpuint, BVH_BINS>();
+          counts.fill(0);
+          for(auto i = first; i < last; ++i) {
+               auto t = input.triangles[i];
+               auto b = std::min(hpuint((input.centroids[t][axis] - centroids.lower[axis]) * scale), BVH_BINS - 1);
+               boxes[b].extend(input.boxes[t]);
+               ++counts[b];
+          }
+
+          //NOTE: The cost of a split is the number of triangles on either side weighted by the area of the side's bounds.
+          auto areas = std::array<hpreal, BVH_BINS>();
+          auto box = BvhBox();
+          auto count = hpuint(0);
+          for(auto b = BVH_BINS - 1; b > 0; --b) {
+               box.extend(boxes[b]);
+               count += counts[b];
+               areas[b] = hpreal(count) * box.getArea();
+          }
+          box = BvhBox();
+          count = 0;
+          for(auto b = hpuint(0); b < BVH_BINS - 1; ++b) {
+               box.extend(boxes[b]);
+               count += counts[b];
+               auto cost = hpreal(count) * box.getArea() + areas[b + 1];
+               if(count > 0 && count < n && cost < bestCost) {
+                    bestAxis = axis;
+                    bestBin = b;
+                    bestCost = cost;
+               }
+          }
+     }
+
+     auto begin = std::begin(input.triangles);
+     if(bestCost == std::numeric_limits<hpreal>::max()) {
+          //NOTE: The centroids cannot be separated by bins; large ranges are halved along the longest axis.
+          if(n <= BVH_MAX_LEAF_SIZE) return first;
+          auto axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z) ? 1 : 2;
+          auto middle = first + n / 2;
+          std::nth_element(begin + first, begin + middle, begin + last, [&](hpuint a, hpuint b) { return input.centroids[a][axis] < input.centroids[b][axis]; });
+          return middle;
+     }
+     if(n <= BVH_MAX_LEAF_SIZE && bestCost >= hpreal(n) * bounds.getArea()) return first;
+
+     auto scale = hpreal(BVH_BINS) / extent[bestAxis];
+     auto middle = std::partition(begin + first, begin + last, [&](hpuint t) { return std::min(hpuint((input.centroids[t][bestAxis] - centroids.lower[bestAxis]) * scale), BVH_BINS - 1) <= bestBin; });
+     return hpuint(middle - begin);
+}
+
+static void build(BvhInput& input, std::vector<Bvh::Node>& nodes, hpuint node, hpuint first, hpuint last) {
+     auto bounds = BvhBox();
+     auto middle = split(input, first, last, bounds);
+     nodes[node].lower = bounds.lower;
+     nodes[node].upper = bounds.upper;
+     if(middle == first) {
+          nodes[node].offset = first;
+          nodes[node].count = last - first;
+          return;
+     }
+     auto left = hpuint(nodes.size());
+     nodes.resize(left + 2);
+     nodes[node].offset = left;
+     nodes[node].count = 0;
+     build(input, nodes, left, first, middle);
+     build(input, nodes, left + 1, middle, last);
+}
+
+Bvh make_bvh(const TriangleMesh<VertexP3>& mesh) {
+     TraceZone zone("bounding volume hierarchy");
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     auto nTriangles = hpuint(indices.size() / 3);
+     auto nThreads = std::max(1u, std::thread::hardware_concurrency());
+     auto input = BvhInput();
+     input.boxes.resize(nTriangles);
+     input.centroids.resize(nTriangles);
+     input.triangles.resize(nTriangles);
+     if(nTriangles == 0) return Bvh({}, {});
+
+     ThreadPool pool(nThreads);
+
+     auto nChunks = std::min(4 * nThreads, nTriangles);
+     auto chunks = std::vector<std::future<void> >();
+     chunks.reserve(nChunks);
+     for(auto c = hpuint(0); c < nChunks; ++c) chunks.push_back(pool.submit([&, c]() {
+          auto end = hpuint(std::uint64_t(nTriangles) * (c + 1) / nChunks);
+          for(auto t = hpuint(std::uint64_t(nTriangles) * c / nChunks); t < end; ++t) {
+               auto& box = input.boxes[t];
+               for(auto i = 0; i < 3; ++i) box.extend(vertices[indices[3 * t + i]].position);
+               input.centroids[t] = hpreal(0.5) * (box.lower + box.upper);
+               input.triangles[t] = t;
+          }
+     }));
+     for(auto& chunk : chunks) chunk.get();
+
+     //NOTE: Ranges smaller than the grain are deferred and built into separate trees in parallel; the top of the tree is split sequentially.
+     auto grain = std::max(nTriangles / (8 * nThreads), hpuint(4096));
+     auto nodes = std::vector<Bvh::Node>(1);
+     auto deferred = std::vector<std::array<hpuint, 3> >();//node, first, last
+     auto top = [&](auto& self, hpuint node, hpuint first, hpuint last) -> void {
+          if(last - first < grain) {
+               deferred.push_back({ node, first, last });
+               return;
+          }
+          auto bounds = BvhBox();
+          auto middle = split(input, first, last, bounds);
+          nodes[node].lower = bounds.lower;
+          nodes[node].upper = bounds.upper;
+          if(middle == first) {
+               nodes[node].offset = first;
+               nodes[node].count = last - first;
+               return;
+          }
+          auto left = hpuint(nodes.size());
+          nodes.resize(left + 2);
+          nodes[node].offset = left;
+          nodes[node].count = 0;
+          self(self, left, first, middle);
+          self(self, left + 1, middle, last);
+     };
+     top(top, 0, 0, nTriangles);
+
+     auto subtrees = std::vector<std::future<std::vector<Bvh::Node> > >();
+     subtrees.reserve(deferred.size());
+     for(auto& range : deferred) subtrees.push_back(pool.submit([&, range]() {
+          auto subtree = std::vector<Bvh::Node>(1);
+          build(input, subtree, 0, range[1], range[2]);
+          return subtree;
+     }));
+
+     //NOTE: The root of a subtree replaces its deferred node and the other nodes are appended; since children come in pairs, the offsets only need to be shifted.
+     for(auto i = std::size_t(0); i < deferred.size(); ++i) {
+          auto subtree = subtrees[i].get();
+          auto shift = hpuint(nodes.size()) - 1;
+          for(auto& node : subtree) if(node.count == 0) node.offset += shift;
+          nodes[deferred[i][0]] = subtree[0];
+          nodes.insert(std::end(nodes), std::begin(subtree) + 1, std::end(subtree));
+     }
+
+     return Bvh(std::move(nodes), std::move(input.triangles));
+}
+
+Pick make_pick(const TriangleMesh<VertexP3>& mesh, const Hit& hit) {
+     auto weights = std::array<hpreal, 3>({ hpreal(1) - hit.u - hit.v, hit.u, hit.v });
+     auto nearest = hpuint(std::max_element(std::begin(weights), std::end(weights)) - std::begin(weights));
+     auto farthest = hpuint(std::min_element(std::begin(weights), std::end(weights)) - std::begin(weights));
+
+     if(weights[nearest] > hpreal(0.75)) return { Pick::Type::VERTEX, hit.triangle, nearest, mesh.getIndices()[3 * hit.triangle + nearest] };
+     if(weights[farthest] < hpreal(0.15)) {
+          auto corner = (farthest + 1) % 3;//NOTE: The edge opposite the farthest corner.
+          return { Pick::Type::EDGE, hit.triangle, corner, 3 * hit.triangle + corner };
+     }
+     return { Pick::Type::TRIANGLE, hit.triangle, 0, hit.triangle };
+}
+
+Bvh::Bvh(std::vector<Node> nodes, std::vector<hpuint> triangles)
+     : m_nodes(std::move(nodes)), m_triangles(std::move(triangles)) {}
+
+Hit Bvh::intersect(const TriangleMesh<VertexP3>& mesh, const Point3D& origin, const Vector3D& direction) const {
+     auto hit = Hit();
+     if(m_nodes.empty()) return hit;
+
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     //NOTE: Zero components are nudged so that the slab test does not multiply zero by infinity when the origin lies on a face of a box.
+     auto nudge = [](hpreal x) { return (std::abs(x) < hpreal(1e-20)) ? std::copysign(hpreal(1e-20), x) : x; };
+     auto inverse = hpreal(1) / Vector3D(nudge(direction.x), nudge(direction.y), nudge(direction.z));
+
+     //NOTE: Returns the distance at which the ray enters the box or the maximum if it misses the box or enters it behind the nearest hit.
+     auto enter = [&](const Node& node) {
+          auto t0 = (node.lower - origin) * inverse;
+          auto t1 = (node.upper - origin) * inverse;
+          auto near = glm::min(t0, t1);
+          auto far = glm::max(t0, t1);
+          auto tmin = std::max(std::max(near.x, near.y), std::max(near.z, hpreal(0)));
+          auto tmax = std::min(std::min(far.x, far.y), std::min(far.z, hit.t));
+          return (tmin <= tmax) ? tmin : std::numeric_limits<hpreal>::max();
+     };
+
+     auto stack = std::vector<hpuint>();
+     stack.reserve(64);
+     if(enter(m_nodes[0]) < std::numeric_limits<hpreal>::max()) stack.push_back(0);
+     while(!stack.empty()) {
+          auto& node = m_nodes[stack.back()];
+          stack.pop_back();
+          if(node.count == 0) {
+               auto t0 = enter(m_nodes[node.offset]);
+               auto t1 = enter(m_nodes[node.offset + 1]);
+               auto near = (t0 <= t1) ? node.offset : node.offset + 1;
+               auto far = (t0 <= t1) ? node.offset + 1 : node.offset;
+               if(std::max(t0, t1) < std::numeric_limits<hpreal>::max()) stack.push_back(far);
+               if(std::min(t0, t1) < std::numeric_limits<hpreal>::max()) stack.push_back(near);
+               continue;
+          }
+          if(enter(node) == std::numeric_limits<hpreal>::max()) continue;//NOTE: A nearer hit may have been found since the node was pushed.
+          for(auto i = node.offset, end = node.offset + node.count; i < end; ++i) {
+               auto t = m_triangles[i];
+               auto& p0 = vertices[indices[3 * t]].position;
+               auto e1 = vertices[indices[3 * t + 1]].position - p0;
+               auto e2 = vertices[indices[3 * t + 2]].position - p0;
+               auto p = glm::cross(direction, e2);
+               auto determinant = glm::dot(e1, p);
+               if(std::abs(determinant) < std::numeric_limits<hpreal>::epsilon()) continue;
+               auto factor = hpreal(1) / determinant;
+               auto s = origin - p0;
+               auto u = glm::dot(s, p) * factor;
+               if(u < 0 || u > 1) continue;
+               auto q = glm::cross(s, e1);
+               auto v = glm::dot(direction, q) * factor;
+               if(v < 0 || u + v > 1) continue;
+               auto distance = glm::dot(e2, q) * factor;
+               if(distance <= 0 || distance >= hit.t) continue;
+               hit.t = distance;
+               hit.triangle = t;
+               hit.u = u;
+               hit.v = v;
+          }
+     }
+     return hit;
+}
+
+void Bvh::refit(const TriangleMesh<VertexP3>& mesh) {
+     TraceZone zone("refit bounding volume hierarchy");
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+
+     //NOTE: Children always come after their parent, so a reverse sweep visits them first.
+     for(auto i = m_nodes.rbegin(); i != m_nodes.rend(); ++i) {
+          auto box = BvhBox();
+          if(i->count == 0) {
+               box.extend(BvhBox{ m_nodes[i->offset].lower, m_nodes[i->offset].upper });
+               box.extend(BvhBox{ m_nodes[i->offset + 1].lower, m_nodes[i->offset + 1].upper });
+          } else for(auto j = i->offset, end = i->offset + i->count; j < end; ++j) for(auto k = 0; k < 3; ++k) box.extend(vertices[indices[3 * m_triangles[j] + k]].position);
+          i->lower = box.lower;
+          i->upper = box.upper;
+     }
+}
+
+}//namespace happah
+
@@ -0,0 +1,80 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <limits>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+class Bvh;
+
+struct Hit;
+
+struct Pick;
+
+//NOTE: Builds a bounding volume hierarchy over the triangles of the mesh with the surface area heuristic.  The top of the tree is split sequentially; the subtrees below it are built in parallel.
+Bvh make_bvh(const TriangleMesh<VertexP3>& mesh);
+
+//NOTE: Classifies a hit by its barycentric coordinates as a hit of the nearest vertex, the nearest edge or the triangle itself.
+Pick make_pick(const TriangleMesh<VertexP3>& mesh, const Hit& hit);
+
+//DEFINITIONS
+
+struct Hit {
+     hpreal t = std::numeric_limits<hpreal>::max();//distance along the ray in multiples of its direction
+     hpuint triangle = std::numeric_limits<hpuint>::max();
+     hpreal u = 0;//barycentric coordinates of the second and third corner
+     hpreal v = 0;
+
+     explicit operator bool() const { return triangle != std::numeric_limits<hpuint>::max(); }
+
+};//Hit
+
+struct Pick {
+     enum class Type { VERTEX, EDGE, TRIANGLE };
+
+     Type type;
+     hpuint triangle;
+     hpuint corner;//first corner of a picked edge; the edge runs to the next corner of the triangle
+     hpuint index;//vertex, edge (3 * triangle + corner), or triangle
+
+};//Pick
+
+class Bvh {
+public:
+     //NOTE: An interior node has no triangles and its two children at offset and offset + 1; a leaf holds the triangles from offset to offset + count in the triangle order.
+     struct Node {
+          Point3D lower;
+          hpuint offset;
+          Point3D upper;
+          hpuint count;
+
+     };//Node
+
+     Bvh(std::vector<Node> nodes, std::vector<hpuint> triangles);
+
+     const std::vector<Node>& getNodes() const { return m_nodes; }
+
+     //NOTE: Returns the nearest hit of the ray with the mesh the hierarchy was built over; the hit is false if the ray misses.
+     Hit intersect(const TriangleMesh<VertexP3>& mesh, const Point3D& origin, const Vector3D& direction) const;
+
+     //NOTE: Updates the bounds after the vertices of the mesh moved.  The tree is kept, which is much cheaper than a rebuild but degrades if the triangles move far; the connectivity must not change.
+     void refit(const TriangleMesh<VertexP3>& mesh);
+
+private:
+     std::vector<Node> m_nodes;
+     std::vector<hpuint> m_triangles;
+
+};//Bvh
+
+}//namespace happah
+
@@ -0,0 +1,169 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+#include "CompactColors.hpp"
+#include "GlslProgram.hpp"
+
+namespace happah {
+
+static const char* const VERTEX_SHADER = R"(
+#version 430 core
+
+layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+layout(std430, binding = 0) readonly buffer Vertices { float vertices[]; };
+
+uniform mat4 modelViewMatrix;
+uniform uint stride;
+
+out vec3 vPosition;
+
+void main() {
+     uint i = uint(gl_VertexID) * stride;
+     vec4 position = modelViewMatrix * vec4(vertices[i], vertices[i + 1], vertices[i + 2], 1.0);
+     vPosition = position.xyz;
+     gl_Position = projectionMatrix * position;
+}
+)";
+
+static const char* const GEOMETRY_SHADER = R"(
+#version 430 core
+
+layout(triangles) in;
+layout(triangle_strip, max_vertices = 3) out;
+
+layout(std430, binding = 1) readonly buffer Palette { uint palette[]; };
+layout(std430, binding = 2) readonly buffer TriangleColors { uint triangleColors[]; };
+layout(std430, binding = 3) readonly buffer SeamColors { uint seamColors[]; };//edge and vertex colors of a triangle
+
+uniform int mode;
+
+in vec3 vPosition[];
+
+out vec3 gBarycentric;
+flat out vec4 gEdgeColors[3];
+flat out vec3 gNormal;
+out vec4 gTriangleColor;
+flat out vec4 gVertexColors[3];
+
+vec4 unpack(uint word, int corner) { return unpackUnorm4x8(palette[(word >> (8 * corner)) & 0xffu]); }
+
+void main() {
+     uint t = uint(gl_PrimitiveIDIn);
+     uint triangle = (mode != 1) ? triangleColors[t] : 0u;
+     uint edges = (mode != 0) ? seamColors[2u * t] : 0u;
+     uint corners = (mode != 0) ? seamColors[2u * t + 1u] : 0u;
+     vec3 normal = normalize(cross(vPosition[1] - vPosition[0], vPosition[2] - vPosition[0]));
+
+     for(int c = 0; c < 3; ++c) {
+          for(int i = 0; i < 3; ++i) {
+               gEdgeColors[i] = unpack(edges, i);
+               gVertexColors[i] = unpack(corners, i);
+          }
+          gBarycentric = vec3(0.0);
+          gBarycentric[c] = 1.0;
+          gNormal = normal;
+          gTriangleColor = unpack(triangle, c);
+          gl_Position = gl_in[c].gl_Position;
+          EmitVertex();
+     }
+     EndPrimitive();
+}
+)";
+
+static const char* const FRAGMENT_SHADER = R"(
+#version 430 core
+
+layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+
+uniform float edgeWidth;
+uniform int mode;
+uniform vec4 modelColor;
+
+in vec3 gBarycentric;
+flat in vec4 gEdgeColors[3];
+flat in vec3 gNormal;
+in vec4 gTriangleColor;
+flat in vec4 gVertexColors[3];
+
+out vec4 color;
+
+void main() {
+     vec4 base = (mode == 1) ? modelColor : gTriangleColor;
+     if(mode != 0) for(int i = 0; i < 3; ++i) if(gBarycentric[(i + 2) % 3] < edgeWidth) base = gEdgeColors[i];//edge i connects corners i and i + 1
+     if(mode == 2) for(int i = 0; i < 3; ++i) if(gBarycentric[i] > 1.0 - 2.0 * edgeWidth) base = gVertexColors[i];
+     color = vec4(base.rgb * (0.2 + 0.8 * abs(dot(gNormal, normalize(light.xyz)))), base.a);
+}
+)";
+
+static std::uint32_t pack(const hpcolor& color) {
+     auto byte = [](hpreal x) { return std::uint32_t(std::round(std::min(std::max(x, hpreal(0)), hpreal(1)) * 255)); };
+     return byte(color.r) | (byte(color.g) << 8) | (byte(color.b) << 16) | (byte(color.a) << 24);
+}
+
+std::vector<std::uint32_t> make_compact_colors(const Palette& palette, const std::vector<hpcolor>& colors) {
+     auto words = std::vector<std::uint32_t>(colors.size() / 3);
+     for(auto t = std::size_t(0); t < words.size(); ++t) words[t] = palette.getIndex(colors[3 * t]) | (palette.getIndex(colors[3 * t + 1]) << 8) | (palette.getIndex(colors[3 * t + 2]) << 16);
+     return words;
+}
+
+Palette::Palette(std::initializer_list<hpcolor> colors) {
+     if(colors.size() > 256) throw std::runtime_error("A palette holds at most 256 colors.");
+     for(auto& color : colors) m_colors.push_back(pack(color));
+}
+
+std::uint8_t Palette::getIndex(const hpcolor& color) const {
+     auto i = std::find(std::begin(m_colors), std::end(m_colors), pack(color));
+     if(i == std::end(m_colors)) throw std::runtime_error("Color is not in the palette.");
+     return std::uint8_t(std::distance(std::begin(m_colors), i));
+}
+
+CompactColors::CompactColors(const Palette& palette) {
+     m_program = make_glsl_program("compact colors", { { GL_VERTEX_SHADER, VERTEX_SHADER }, { GL_GEOMETRY_SHADER, GEOMETRY_SHADER }, { GL_FRAGMENT_SHADER, FRAGMENT_SHADER } });
+     glCreateVertexArrays(1, &m_vertexArray);
+     glCreateBuffers(3, m_buffers);
+     glNamedBufferStorage(m_buffers[0], palette.getColors().size() * sizeof(std::uint32_t), palette.getColors().data(), 0);
+}
+
+CompactColors::~CompactColors() {
+     glDeleteBuffers(3, m_buffers);
+     glDeleteVertexArrays(1, &m_vertexArray);
+     glDeleteProgram(m_program);
+}
+
+void CompactColors::render(Mode mode, GLuint vertices, GLuint indices, hpuint stride, hpuint nTriangles, const glm::mat4& modelViewMatrix, const hpcolor& modelColor, hpreal edgeWidth) {
+     glUseProgram(m_program);
+     glUniformMatrix4fv(glGetUniformLocation(m_program, "modelViewMatrix"), 1, GL_FALSE, glm::value_ptr(modelViewMatrix));
+     glUniform1ui(glGetUniformLocation(m_program, "stride"), stride);
+     glUniform1i(glGetUniformLocation(m_program, "mode"), GLint(mode));
+     glUniform1f(glGetUniformLocation(m_program, "edgeWidth"), edgeWidth);
+     glUniform4fv(glGetUniformLocation(m_program, "modelColor"), 1, glm::value_ptr(glm::vec4(modelColor)));
+     glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, vertices);
+     for(auto i = 0; i < 3; ++i) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i + 1, m_buffers[i]);
+     glVertexArrayElementBuffer(m_vertexArray, indices);
+     glBindVertexArray(m_vertexArray);
+     glDrawElements(GL_TRIANGLES, 3 * nTriangles, GL_UNSIGNED_INT, nullptr);
+}
+
+void CompactColors::setSeamColors(const std::vector<std::uint32_t>& edgeColors, const std::vector<std::uint32_t>& vertexColors) {
+     auto words = std::vector<std::uint32_t>(2 * edgeColors.size());
+     for(auto t = std::size_t(0); t < edgeColors.size(); ++t) {
+          words[2 * t] = edgeColors[t];
+          words[2 * t + 1] = vertexColors[t];
+     }
+     glNamedBufferData(m_buffers[2], words.size() * sizeof(std::uint32_t), words.data(), GL_STATIC_DRAW);
+     m_nSeamColors = hpuint(edgeColors.size());
+}
+
+void CompactColors::setTriangleColors(const std::vector<std::uint32_t>& triangleColors) {
+     glNamedBufferData(m_buffers[1], triangleColors.size() * sizeof(std::uint32_t), triangleColors.data(), GL_STATIC_DRAW);
+     m_nTriangleColors = hpuint(triangleColors.size());
+}
+
+}//namespace happah
+
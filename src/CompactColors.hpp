@@ -0,0 +1,76 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+class CompactColors;
+
+class Palette;
+
+//NOTE: Packs per-corner colors (three per triangle) into one word per triangle, one palette index per byte.
+std::vector<std::uint32_t> make_compact_colors(const Palette& palette, const std::vector<hpcolor>& colors);
+
+//DEFINITIONS
+
+//NOTE: At most 256 colors stored as RGBA8.
+class Palette {
+public:
+     Palette(std::initializer_list<hpcolor> colors);
+
+     const std::vector<std::uint32_t>& getColors() const { return m_colors; }
+
+     std::uint8_t getIndex(const hpcolor& color) const;
+
+private:
+     std::vector<std::uint32_t> m_colors;
+
+};//Palette
+
+//NOTE: Draws the triangle colors, edges and patches panels from the indexed mesh instead of a triangle array and three per-corner color buffers.  The geometry shader looks up the colors of a triangle by gl_PrimitiveID in shader storage buffers that hold one palette index per corner, which takes 12 instead of 144 bytes per triangle.
+class CompactColors {
+public:
+     enum class Mode : GLint { TRIANGLE_COLORS, EDGES, PATCHES };
+
+     CompactColors(const Palette& palette);
+
+     CompactColors(const CompactColors& colors) = delete;
+
+     ~CompactColors();
+
+     CompactColors& operator=(const CompactColors& colors) = delete;
+
+     bool hasSeamColors() const { return m_nSeamColors > 0; }
+
+     bool hasTriangleColors() const { return m_nTriangleColors > 0; }
+
+     //NOTE: The vertices are read from the vertex buffer as floats with the given stride; the positions must be the first three floats of a vertex.  The projection matrix and the light are read from the frame uniform block (see FrameUniforms).
+     void render(Mode mode, GLuint vertices, GLuint indices, hpuint stride, hpuint nTriangles, const glm::mat4& modelViewMatrix, const hpcolor& modelColor, hpreal edgeWidth);
+
+     void setSeamColors(const std::vector<std::uint32_t>& edgeColors, const std::vector<std::uint32_t>& vertexColors);
+
+     void setTriangleColors(const std::vector<std::uint32_t>& triangleColors);
+
+private:
+     GLuint m_buffers[3];//palette, triangle colors, edge and vertex colors
+     hpuint m_nSeamColors = 0;
+     hpuint m_nTriangleColors = 0;
+     GLuint m_program;
+     GLuint m_vertexArray;
+
+};//CompactColors
+
+}//namespace happah
+
@@ -0,0 +1,146 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Culling.hpp"
+#include "GlslProgram.hpp"
+
+namespace happah {
+
+static const char* const BOX_VERTEX_SHADER = R"(
+#version 430 core
+
+layout(location = 0) in vec3 position;
+
+uniform mat4 matrix;
+
+void main() { gl_Position = matrix * vec4(position, 1.0); }
+)";
+
+static const char* const BOX_FRAGMENT_SHADER = R"(
+#version 430 core
+
+void main() {}
+)";
+
+bool is_in_frustum(const glm::mat4& matrix, const Point3D& lower, const Point3D& upper) {
+     //NOTE: The box is outside if all its corners are outside the same plane; the bits of a mask are the planes a corner is outside of.
+     auto common = 0x3f;
+     for(auto i = 0; i < 8; ++i) {
+          auto p = matrix * glm::vec4((i & 1) ? upper.x : lower.x, (i & 2) ? upper.y : lower.y, (i & 4) ? upper.z : lower.z, 1.0f);
+          common &= (p.x < -p.w) | ((p.x > p.w) << 1) | ((p.y < -p.w) << 2) | ((p.y > p.w) << 3) | ((p.z < -p.w) << 4) | ((p.z > p.w) << 5);
+          if(!common) return true;
+     }
+     return false;
+}
+
+PanelCuller::PanelCuller() {
+     m_inFrustum.fill(false);
+     m_occluded.fill(false);
+     m_pending.fill(false);
+
+     m_program = make_glsl_program("box", { { GL_VERTEX_SHADER, BOX_VERTEX_SHADER }, { GL_FRAGMENT_SHADER, BOX_FRAGMENT_SHADER } });
+
+     static const float corners[] = { 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1 };
+     static const GLuint indices[] = { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+     glCreateBuffers(2, m_buffers);
+     glNamedBufferStorage(m_buffers[0], sizeof(corners), corners, 0);
+     glNamedBufferStorage(m_buffers[1], sizeof(indices), indices, 0);
+     glCreateVertexArrays(1, &m_vertexArray);
+     glVertexArrayVertexBuffer(m_vertexArray, 0, m_buffers[0], 0, 3 * sizeof(float));
+     glVertexArrayAttribFormat(m_vertexArray, 0, 3, GL_FLOAT, GL_FALSE, 0);
+     glVertexArrayAttribBinding(m_vertexArray, 0, 0);
+     glEnableVertexArrayAttrib(m_vertexArray, 0);
+     glVertexArrayElementBuffer(m_vertexArray, m_buffers[1]);
+
+     glGenQueries(GLsizei(m_queries.size()), m_queries.data());
+}
+
+PanelCuller::~PanelCuller() {
+     glDeleteQueries(GLsizei(m_queries.size()), m_queries.data());
+     glDeleteVertexArrays(1, &m_vertexArray);
+     glDeleteBuffers(2, m_buffers);
+     glDeleteProgram(m_program);
+}
+
+Panels PanelCuller::cull(const Panels& shown, const glm::mat4& projectionMatrix, const std::array<glm::mat4, Panels::SIZE>& modelViewMatrices, const Point3D& lower, const Point3D& upper) {
+     update();
+
+     //NOTE: The spline surfaces and impostors reach a little beyond the control mesh.
+     auto margin = hpreal(0.05) * (upper - lower);
+     m_lower = lower - margin;
+     m_upper = upper + margin;
+     auto box = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(m_lower)), glm::vec3(m_upper - m_lower));
+
+     auto panels = Panels(false);
+     m_counts = CullingCounts();
+     for(auto i = hpuint(0); i < Panels::SIZE; ++i) {
+          auto panel = Panel(i);
+          m_inFrustum[i] = false;
+          if(!shown[panel]) {
+               m_occluded[i] = false;
+               continue;
+          }
+          auto matrix = projectionMatrix * modelViewMatrices[i];
+          if(!is_in_frustum(matrix, m_lower, m_upper)) {
+               m_occluded[i] = false;
+               ++m_counts.nFrustumCulled;
+               continue;
+          }
+          m_inFrustum[i] = true;
+          m_matrices[i] = matrix * box;
+          auto eye = glm::vec3(glm::inverse(modelViewMatrices[i])[3]);
+          if(glm::all(glm::greaterThanEqual(eye, glm::vec3(m_lower))) && glm::all(glm::lessThanEqual(eye, glm::vec3(m_upper)))) m_occluded[i] = false;
+          if(m_occluded[i]) {
+               ++m_counts.nOccluded;
+               continue;
+          }
+          panels.setVisible(panel, true);
+          ++m_counts.nDrawn;
+     }
+     m_totals.nDrawn += m_counts.nDrawn;
+     m_totals.nFrustumCulled += m_counts.nFrustumCulled;
+     m_totals.nOccluded += m_counts.nOccluded;
+     ++m_nFrames;
+     return panels;
+}
+
+void PanelCuller::query() {
+     glUseProgram(m_program);
+     glBindVertexArray(m_vertexArray);
+     glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+     glDepthMask(GL_FALSE);
+     glEnable(GL_DEPTH_TEST);
+     auto location = glGetUniformLocation(m_program, "matrix");
+     for(auto i = hpuint(0); i < Panels::SIZE; ++i) {
+          if(!m_inFrustum[i]) continue;
+          glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(m_matrices[i]));
+          glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, m_queries[i]);
+          glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, nullptr);
+          glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+          m_pending[i] = true;
+     }
+     glDepthMask(GL_TRUE);
+     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+     glBindVertexArray(0);
+}
+
+bool PanelCuller::update() {
+     auto revealed = false;
+     for(auto i = hpuint(0); i < Panels::SIZE; ++i) {
+          if(!m_pending[i]) continue;
+          auto passed = GLuint(0);
+          glGetQueryObjectuiv(m_queries[i], GL_QUERY_RESULT, &passed);
+          m_pending[i] = false;
+          revealed |= m_occluded[i] && passed;
+          m_occluded[i] = !passed;
+     }
+     return revealed;
+}
+
+}//namespace happah
+
@@ -0,0 +1,79 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics/glad.h>
+#include <glm/glm.hpp>
+#include <array>
+
+#include "Panels.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+struct CullingCounts;
+
+class PanelCuller;
+
+//NOTE: Returns true if the box, transformed by the matrix into clip space, is not entirely outside one of the planes of the view frustum.
+bool is_in_frustum(const glm::mat4& matrix, const Point3D& lower, const Point3D& upper);
+
+//DEFINITIONS
+
+struct CullingCounts {
+     hpuint nDrawn = 0;
+     hpuint nFrustumCulled = 0;
+     hpuint nOccluded = 0;
+
+};//CullingCounts
+
+//NOTE: Skips the panels whose bounding boxes are outside the view frustum or were hidden behind other panels in the previous frame.  After the panels are drawn, the bounding box of every panel in the frustum is drawn into the depth buffer without writing to it inside an occlusion query; the results are read at the beginning of the next frame.  A panel that comes out from behind another one therefore appears one frame late, and a panel is never culled while the camera is inside its box.
+class PanelCuller {
+public:
+     PanelCuller();
+
+     PanelCuller(const PanelCuller& culler) = delete;
+
+     ~PanelCuller();
+
+     PanelCuller& operator=(const PanelCuller& culler) = delete;
+
+     //NOTE: Returns the shown panels that are to be drawn.  The box is the bounding box of the model that every panel draws at its model view matrix.
+     Panels cull(const Panels& shown, const glm::mat4& projectionMatrix, const std::array<glm::mat4, Panels::SIZE>& modelViewMatrices, const Point3D& lower, const Point3D& upper);
+
+     const CullingCounts& getCounts() const { return m_counts; }//in the last frame
+
+     hpuint getNumberOfFrames() const { return m_nFrames; }
+
+     const CullingCounts& getTotals() const { return m_totals; }//over all frames
+
+     //NOTE: Issues the occlusion queries of the panels in the frustum; call after the panels have been drawn.
+     void query();
+
+     //NOTE: Reads the results of the last queries and returns true if a panel that was occluded in the last frame is visible now.
+     bool update();
+
+private:
+     CullingCounts m_counts;
+     std::array<bool, Panels::SIZE> m_inFrustum;
+     Point3D m_lower;
+     std::array<glm::mat4, Panels::SIZE> m_matrices;//box to clip space
+     hpuint m_nFrames = 0;
+     std::array<bool, Panels::SIZE> m_occluded;
+     std::array<bool, Panels::SIZE> m_pending;
+     GLuint m_program;
+     std::array<GLuint, Panels::SIZE> m_queries;
+     CullingCounts m_totals;
+     Point3D m_upper;
+     GLuint m_vertexArray;
+     GLuint m_buffers[2];//corners and indices of the unit cube
+
+};//PanelCuller
+
+}//namespace happah
+
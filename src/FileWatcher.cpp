@@ -0,0 +1,78 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "FileWatcher.hpp"
+
+namespace happah {
+
+FileWatcher::FileWatcher(std::function<void()> notify)
+     : m_file(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)), m_notify(std::move(notify)) {
+     if(m_file < 0) throw std::runtime_error("Failed to initialize inotify.");
+     if(pipe2(m_wake, O_CLOEXEC) < 0) {
+          close(m_file);
+          throw std::runtime_error("Failed to create the wake-up pipe of the file watcher.");
+     }
+     m_thread = std::thread([this]() {
+          alignas(struct inotify_event) char buffer[4096];
+          pollfd files[] = { { m_file, POLLIN, 0 }, { m_wake[0], POLLIN, 0 } };
+          while(true) {
+               if(poll(files, 2, -1) < 0) continue;
+               if(files[1].revents) return;
+               auto changed = false;
+               auto n = ssize_t(0);
+               while((n = read(m_file, buffer, sizeof(buffer))) > 0) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    for(auto i = buffer; i < buffer + n; ) {
+                         auto event = reinterpret_cast<const struct inotify_event*>(i);
+                         i += sizeof(struct inotify_event) + event->len;
+                         if(!event->len) continue;
+                         auto file = m_files.find(std::make_pair(event->wd, std::string(event->name)));
+                         if(file == std::end(m_files)) continue;
+                         changed |= m_changes.insert(file->second).second;
+                    }
+               }
+               if(changed && m_notify) m_notify();
+          }
+     });
+}
+
+FileWatcher::~FileWatcher() {
+     auto byte = char(0);
+     if(write(m_wake[1], &byte, 1) < 0) {}//NOTE: Writing one byte into the empty pipe cannot fail.
+     m_thread.join();
+     close(m_wake[0]);
+     close(m_wake[1]);
+     close(m_file);
+}
+
+std::vector<std::string> FileWatcher::getChanges() {
+     std::lock_guard<std::mutex> lock(m_mutex);
+     auto changes = std::vector<std::string>(std::begin(m_changes), std::end(m_changes));
+     m_changes.clear();
+     return changes;
+}
+
+void FileWatcher::watch(const std::string& path) {
+     auto slash = path.rfind('/');
+     auto directory = (slash == std::string::npos) ? std::string(".") : (slash == 0) ? std::string("/") : path.substr(0, slash);
+     auto name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+     std::lock_guard<std::mutex> lock(m_mutex);
+     auto entry = m_directories.find(directory);
+     if(entry == std::end(m_directories)) {
+          auto watch = inotify_add_watch(m_file, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+          if(watch < 0) throw std::runtime_error("Failed to watch " + directory + '.');
+          entry = m_directories.emplace(directory, watch).first;
+     }
+     m_files[std::make_pair(entry->second, name)] = path;
+}
+
+}//namespace happah
+
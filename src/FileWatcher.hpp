@@ -0,0 +1,56 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+class FileWatcher;
+
+//DEFINITIONS
+
+//NOTE: Reports files that have been rewritten through inotify.  The directories of the files are watched instead of the files themselves so that a file that an editor saves by renaming a new file over it is still reported.  A file is reported once it has been closed after writing or moved into place, never while it is being written.
+class FileWatcher {
+public:
+     //NOTE: notify is called on the watching thread when a watched file has changed.
+     FileWatcher(std::function<void()> notify = std::function<void()>());
+
+     FileWatcher(const FileWatcher& watcher) = delete;
+
+     ~FileWatcher();
+
+     FileWatcher& operator=(const FileWatcher& watcher) = delete;
+
+     //NOTE: Returns the watched files that changed since the last call in the form in which they were passed to watch.
+     std::vector<std::string> getChanges();
+
+     void watch(const std::string& path);
+
+private:
+     std::set<std::string> m_changes;
+     std::map<std::string, int> m_directories;//watch per directory
+     std::map<std::pair<int, std::string>, std::string> m_files;//path per watch and name
+     int m_file;//inotify instance
+     std::mutex m_mutex;
+     std::function<void()> m_notify;
+     int m_wake[2];//pipe that stops the thread
+     std::thread m_thread;
+
+};//FileWatcher
+
+}//namespace happah
+
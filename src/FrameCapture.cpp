@@ -0,0 +1,127 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+
+#include "FrameCapture.hpp"
+#include "Png.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+static bool is_raw(const std::string& path) { return path.size() >= 4 && path.compare(path.size() - 4, 4, ".rgb") == 0; }
+
+//NOTE: Raw frames are appended in order by one writer; PNG frames are independent and encoded by half of the threads of the machine.  The ring has two buffers more than there are writers so that the GPU can read a frame while the previous one waits for its fence and every writer is busy.
+FrameCapture::FrameCapture(const std::string& path, hpuint width, hpuint height)
+     : m_height(height), m_path(path), m_raw(is_raw(path)), m_width(width) {
+     auto nWriters = (m_raw) ? 1u : std::max(1u, std::thread::hardware_concurrency() / 2);
+     if(m_raw) {
+          m_stream.open(path, std::ios::binary);
+          if(!m_stream) throw std::runtime_error("Failed to open " + path + '.');
+     } else if(mkdir(path.c_str(), 0755) < 0 && errno != EEXIST) throw std::runtime_error("Failed to create " + path + '.');
+
+     auto size = GLsizeiptr(3) * width * height;
+     m_slots.resize(nWriters + 2);
+     for(auto& slot : m_slots) {
+          glCreateBuffers(1, &slot.buffer);
+          glNamedBufferStorage(slot.buffer, size, nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+          slot.data = (const unsigned char*)glMapNamedBufferRange(slot.buffer, 0, size, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+          if(!slot.data) throw std::runtime_error("Failed to map capture buffer.");
+     }
+     m_writers = std::make_unique<ThreadPool>(nWriters);
+}
+
+FrameCapture::~FrameCapture() {
+     try {
+          finish();
+     } catch(std::exception& e) {
+          std::cerr << "WARNING: " << e.what() << std::endl;
+     }
+     m_writers.reset();
+     for(auto& slot : m_slots) {
+          if(slot.fence) glDeleteSync(slot.fence);
+          glUnmapNamedBuffer(slot.buffer);
+          glDeleteBuffers(1, &slot.buffer);
+     }
+}
+
+void FrameCapture::capture(GLuint framebuffer, const std::string& path) {
+     if(m_raw && !path.empty()) throw std::runtime_error("Raw frames cannot be written to their own files.");
+     TraceZone zone("capture");
+     auto& slot = m_slots[m_nFrames % m_slots.size()];
+     if(slot.fence || slot.write.valid()) {
+          auto start = Profiler::Clock::now();
+          auto ready = (!slot.fence || glClientWaitSync(slot.fence, 0, 0) != GL_TIMEOUT_EXPIRED) && (!slot.write.valid() || slot.write.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+          retire(slot, true);
+          if(!ready) {
+               ++m_nStalls;
+               m_stallTime += Profiler::Clock::now() - start;
+          }
+     }
+
+     glNamedFramebufferReadBuffer(framebuffer, (framebuffer) ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+     glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+     glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+     glPixelStorei(GL_PACK_ALIGNMENT, 1);
+     glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+     slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+     slot.frame = m_nFrames++;
+     slot.path = path;
+     zone.addBytes(std::size_t(3) * m_width * m_height);
+
+     //NOTE: The frames whose fences have signaled are handed to the writers oldest first, which keeps raw frames in order.
+     for(auto i = hpuint(0); i + 1 < m_slots.size(); ++i) {
+          auto& next = m_slots[(m_nFrames + i) % m_slots.size()];
+          if(!next.fence) continue;
+          if(glClientWaitSync(next.fence, 0, 0) == GL_TIMEOUT_EXPIRED) break;
+          retire(next, false);
+     }
+}
+
+void FrameCapture::finish() {
+     for(auto i = hpuint(0); i < m_slots.size(); ++i) retire(m_slots[(m_nFrames + i) % m_slots.size()], true);
+     if(m_raw) m_stream.flush();
+}
+
+void FrameCapture::retire(Slot& slot, bool wait) {
+     if(slot.fence) {
+          while(glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+          glDeleteSync(slot.fence);
+          slot.fence = nullptr;
+          auto data = slot.data;
+          auto frame = slot.frame;
+          auto path = slot.path;
+          if(m_raw) slot.write = m_writers->submit([this, data]() {
+               TraceZone zone("write frame");
+               auto stride = std::size_t(3) * m_width;
+               for(auto y = m_height; y > 0; --y) m_stream.write((const char*)data + stride * (y - 1), stride);
+               if(!m_stream) throw std::runtime_error("Failed to write " + m_path + '.');
+          });
+          else if(path.empty()) slot.write = m_writers->submit([this, data, frame]() {
+               char name[32];
+               std::snprintf(name, sizeof(name), "/frame-%06u.png", frame);
+               write_png(m_path + name, m_width, m_height, data);
+          });
+          else slot.write = m_writers->submit([this, data, path]() {
+               try {
+                    write_png(path, m_width, m_height, data);
+               } catch(std::exception& e) {
+                    std::cerr << "WARNING: " << e.what() << std::endl;
+               }
+          });
+     }
+     if(wait && slot.write.valid()) slot.write.get();
+}
+
+}//namespace happah
+
@@ -0,0 +1,79 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics/glad.h>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+class FrameCapture;
+
+//DEFINITIONS
+
+//NOTE: Captures the frames drawn into a framebuffer without stalling the pipeline.  A frame is read asynchronously into the next pixel buffer object of a ring and followed by a fence; once the fence has signaled, the writer threads encode the frame straight from the persistent mapping of the buffer.  The render thread only waits when the ring wraps around to a buffer that is still being read or written.
+class FrameCapture {
+public:
+     //NOTE: If path ends in .rgb, the frames are appended to it as raw 8-bit RGB images with rows from top to bottom; otherwise, path is a directory to which frame-000000.png, frame-000001.png and so on are written.
+     FrameCapture(const std::string& path, hpuint width, hpuint height);
+
+     FrameCapture(const FrameCapture& capture) = delete;
+
+     ~FrameCapture();
+
+     FrameCapture& operator=(const FrameCapture& capture) = delete;
+
+     //NOTE: Reads the lower left width by height pixels of the framebuffer (0 for the back buffer of the window); call after the frame has been drawn and before the buffers are swapped.  If path is not empty, the frame is written to it as a PNG file instead of to the numbered file, and a failed write only prints a warning so that a batch of images goes on.
+     void capture(GLuint framebuffer, const std::string& path = std::string());
+
+     //NOTE: Waits until every captured frame has been written.
+     void finish();
+
+     hpuint getNumberOfFrames() const { return m_nFrames; }
+
+     hpuint getNumberOfStalls() const { return m_nStalls; }//frames that waited for a buffer
+
+     Profiler::Clock::duration getStallTime() const { return m_stallTime; }
+
+private:
+     struct Slot {
+          GLuint buffer;
+          const unsigned char* data;//persistent mapping
+          GLsync fence = nullptr;//while the frame is read
+          hpuint frame = 0;
+          std::string path;//if the frame is not numbered
+          std::future<void> write;//while the frame is written
+
+     };//Slot
+
+     hpuint m_height;
+     hpuint m_nFrames = 0;
+     hpuint m_nStalls = 0;
+     std::string m_path;
+     bool m_raw;
+     std::vector<Slot> m_slots;
+     Profiler::Clock::duration m_stallTime = Profiler::Clock::duration(0);
+     std::ofstream m_stream;//of raw frames
+     hpuint m_width;
+     std::unique_ptr<ThreadPool> m_writers;//NOTE: Destroyed first so that no write outlives the buffers.
+
+     //NOTE: Hands the frame of the slot to the writers once it has been read; if wait is true, waits until it has been read and written.
+     void retire(Slot& slot, bool wait);
+
+};//FrameCapture
+
+}//namespace happah
+
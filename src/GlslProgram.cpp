@@ -0,0 +1,60 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <vector>
+
+#include "GlslProgram.hpp"
+
+namespace happah {
+
+const char* const FLAT_FRAGMENT_SHADER = R"(
+#version 430 core
+
+layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+
+uniform vec4 modelColor;
+
+in vec3 vPosition;
+
+out vec4 color;
+
+void main() {
+     vec3 normal = normalize(cross(dFdx(vPosition), dFdy(vPosition)));
+     color = vec4(modelColor.rgb * (0.2 + 0.8 * abs(dot(normal, normalize(light.xyz)))), modelColor.a);
+}
+)";
+
+GLuint make_glsl_program(const std::string& label, std::initializer_list<std::pair<GLenum, const char*> > shaders) {
+     auto ids = std::vector<GLuint>();
+     auto log = std::string(1024, '\0');
+     auto status = GLint(GL_FALSE);
+     for(auto& shader : shaders) {
+          auto id = glCreateShader(shader.first);
+          ids.push_back(id);
+          glShaderSource(id, 1, &shader.second, nullptr);
+          glCompileShader(id);
+          glGetShaderiv(id, GL_COMPILE_STATUS, &status);
+          if(status != GL_TRUE) {
+               glGetShaderInfoLog(id, GLsizei(log.size()), nullptr, &log[0]);
+               for(auto id : ids) glDeleteShader(id);
+               throw std::runtime_error("Failed to compile " + label + " shader: " + log.c_str());
+          }
+     }
+     auto program = glCreateProgram();
+     for(auto id : ids) glAttachShader(program, id);
+     glLinkProgram(program);
+     for(auto id : ids) glDeleteShader(id);
+     glGetProgramiv(program, GL_LINK_STATUS, &status);
+     if(status != GL_TRUE) {
+          glGetProgramInfoLog(program, GLsizei(log.size()), nullptr, &log[0]);
+          glDeleteProgram(program);
+          throw std::runtime_error("Failed to link " + label + " program: " + log.c_str());
+     }
+     return program;
+}
+
+}//namespace happah
+
@@ -0,0 +1,24 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/graphics/glad.h>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace happah {
+
+//DECLARATIONS
+
+//NOTE: Shades modelColor with the light of the frame uniform block (see FrameUniforms) and the normal of the triangle, which is derived from the screen-space derivatives of vPosition, the position in view coordinates.
+extern const char* const FLAT_FRAGMENT_SHADER;
+
+//NOTE: Compiles the shaders, each given by its type and source, and links them into a program.  If a shader does not compile or the program does not link, the exception names the program by label and carries the log of the driver.
+GLuint make_glsl_program(const std::string& label, std::initializer_list<std::pair<GLenum, const char*> > shaders);
+
+}//namespace happah
+
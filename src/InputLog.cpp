@@ -0,0 +1,94 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "InputLog.hpp"
+
+namespace happah {
+
+static const std::string INPUT_LOG_MAGIC = "happah-input";
+static constexpr hpuint INPUT_LOG_VERSION = 1;
+
+InputEvent make_cursor_pos_event(double x, double y) {
+     auto event = InputEvent();
+     event.type = InputEvent::Type::CURSOR_POS;
+     event.x = x;
+     event.y = y;
+     return event;
+}
+
+InputEvent make_frame_event() { return InputEvent(); }
+
+InputEvent make_key_event(hpint key, hpint code, hpint action, hpint mods) {
+     auto event = InputEvent();
+     event.type = InputEvent::Type::KEY;
+     event.key = key;
+     event.code = code;
+     event.action = action;
+     event.mods = mods;
+     return event;
+}
+
+InputEvent make_mouse_button_event(hpint button, hpint action, hpint mods, double x, double y) {
+     auto event = InputEvent();
+     event.type = InputEvent::Type::MOUSE_BUTTON;
+     event.key = button;
+     event.action = action;
+     event.mods = mods;
+     event.x = x;
+     event.y = y;
+     return event;
+}
+
+InputEvent make_scroll_event(double xoffset, double yoffset) {
+     auto event = InputEvent();
+     event.type = InputEvent::Type::SCROLL;
+     event.x = xoffset;
+     event.y = yoffset;
+     return event;
+}
+
+std::tuple<hpuint, hpuint, std::vector<InputEvent> > read_input_log(const std::string& path) {
+     auto stream = std::ifstream(path);
+     if(!stream) throw std::runtime_error("Failed to open input log " + path + '.');
+
+     auto magic = std::string();
+     auto version = hpuint(0);
+     auto width = hpuint(0);
+     auto height = hpuint(0);
+     if(!(stream >> magic >> version >> width >> height) || magic != INPUT_LOG_MAGIC || version != INPUT_LOG_VERSION) throw std::runtime_error(path + " is not an input log of this version.");
+
+     auto events = std::vector<InputEvent>();
+     auto line = std::string();
+     std::getline(stream, line);
+     for(auto n = hpuint(2); std::getline(stream, line); ++n) {
+          if(line.empty()) continue;
+          auto event = InputEvent();
+          auto type = hpint(0);
+          auto record = std::istringstream(line);
+          if(!(record >> event.time >> type >> event.key >> event.code >> event.action >> event.mods >> event.x >> event.y) || type < 0 || type > hpint(InputEvent::Type::SCROLL)) throw std::runtime_error("Invalid event in line " + std::to_string(n) + " of " + path + '.');
+          event.type = InputEvent::Type(type);
+          events.push_back(event);
+     }
+     return std::make_tuple(width, height, std::move(events));
+}
+
+InputRecorder::InputRecorder(const std::string& path, hpuint width, hpuint height)
+     : m_start(std::chrono::steady_clock::now()), m_stream(path) {
+     if(!m_stream) throw std::runtime_error("Failed to open input log " + path + '.');
+     m_stream << INPUT_LOG_MAGIC << ' ' << INPUT_LOG_VERSION << ' ' << width << ' ' << height << '\n' << std::setprecision(17);
+}
+
+void InputRecorder::write(InputEvent event) {
+     event.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+     m_stream << event.time << ' ' << hpint(event.type) << ' ' << event.key << ' ' << event.code << ' ' << event.action << ' ' << event.mods << ' ' << event.x << ' ' << event.y << '\n';
+     //NOTE: The log is flushed at frame boundaries so that a session that is killed keeps all but its last frame.
+     if(event.type == InputEvent::Type::FRAME) m_stream.flush();
+}
+
+}//namespace happah
@@ -0,0 +1,67 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+struct InputEvent;
+
+class InputRecorder;
+
+InputEvent make_cursor_pos_event(double x, double y);
+
+InputEvent make_frame_event();
+
+InputEvent make_key_event(hpint key, hpint code, hpint action, hpint mods);
+
+InputEvent make_mouse_button_event(hpint button, hpint action, hpint mods, double x, double y);
+
+InputEvent make_scroll_event(double xoffset, double yoffset);
+
+//NOTE: Reads a log written by an input recorder and returns the size of the window it was recorded in and its events.
+std::tuple<hpuint, hpuint, std::vector<InputEvent> > read_input_log(const std::string& path);
+
+//DEFINITIONS
+
+//NOTE: A window event as GLFW reports it.  Cursor positions are in screen coordinates from the upper left corner; mouse button events carry the cursor position at the time of the click.  A frame event marks that a frame was drawn.
+struct InputEvent {
+     enum class Type : hpint { CURSOR_POS, FRAME, KEY, MOUSE_BUTTON, SCROLL };
+
+     double time = 0.0;//seconds since the recording started
+     Type type = Type::FRAME;
+     hpint key = 0;//key or mouse button
+     hpint code = 0;
+     hpint action = 0;
+     hpint mods = 0;
+     double x = 0.0;//cursor position or scroll offset
+     double y = 0.0;
+
+};//InputEvent
+
+//NOTE: Writes events with their time to a text log, one event per line after a header with the size of the window.
+class InputRecorder {
+public:
+     InputRecorder(const std::string& path, hpuint width, hpuint height);
+
+     void write(InputEvent event);
+
+private:
+     std::chrono::steady_clock::time_point m_start;
+     std::ofstream m_stream;
+
+};//InputRecorder
+
+}//namespace happah
+
@@ -0,0 +1,272 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+#include "Lod.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+//NOTE: The sum of the squared distances to a set of planes as x^T A x + 2 b^T x + c; A is symmetric and stored as its upper triangle.
+struct Quadric {
+     double a[6] = { 0, 0, 0, 0, 0, 0 };//xx, xy, xz, yy, yz, zz
+     double b[3] = { 0, 0, 0 };
+     double c = 0;
+
+     void add(const Quadric& quadric) {
+          for(auto i = 0; i < 6; ++i) a[i] += quadric.a[i];
+          for(auto i = 0; i < 3; ++i) b[i] += quadric.b[i];
+          c += quadric.c;
+     }
+
+     double evaluate(const Point3D& p) const {
+          double x = p.x, y = p.y, z = p.z;
+          return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + a[3] * y * y + 2 * a[4] * y * z + a[5] * z * z + 2 * (b[0] * x + b[1] * y + b[2] * z) + c;
+     }
+
+};//Quadric
+
+struct Collapse {
+     double cost;
+     hpuint u;//removed
+     hpuint v;//kept
+     hpuint stampU;
+     hpuint stampV;
+     Point3D target;
+
+     bool operator<(const Collapse& collapse) const { return cost > collapse.cost; }//NOTE: The priority queue pops the cheapest collapse first.
+
+};//Collapse
+
+static Quadric make_quadric(const Point3D& p0, const Point3D& p1, const Point3D& p2) {
+     auto quadric = Quadric();
+     auto normal = glm::cross(p1 - p0, p2 - p0);
+     auto length = glm::length(normal);
+     if(length == 0) return quadric;
+     auto area = 0.5 * length;
+     double n[3] = { normal.x / length, normal.y / length, normal.z / length };
+     auto d = -(n[0] * p0.x + n[1] * p0.y + n[2] * p0.z);
+     quadric.a[0] = area * n[0] * n[0];
+     quadric.a[1] = area * n[0] * n[1];
+     quadric.a[2] = area * n[0] * n[2];
+     quadric.a[3] = area * n[1] * n[1];
+     quadric.a[4] = area * n[1] * n[2];
+     quadric.a[5] = area * n[2] * n[2];
+     for(auto i = 0; i < 3; ++i) quadric.b[i] = area * d * n[i];
+     quadric.c = area * d * d;
+     return quadric;
+}
+
+//NOTE: Returns the position that minimizes the quadric if its matrix is well conditioned and otherwise the best of the two endpoints and the midpoint.
+static Point3D make_target(const Quadric& q, const Point3D& p0, const Point3D& p1) {
+     auto& a = q.a;
+     auto det = a[0] * (a[3] * a[5] - a[4] * a[4]) - a[1] * (a[1] * a[5] - a[4] * a[2]) + a[2] * (a[1] * a[4] - a[3] * a[2]);
+     auto scale = std::max({ std::abs(a[0]), std::abs(a[3]), std::abs(a[5]) });
+     if(std::abs(det) > 1e-9 * scale * scale * scale) {
+          //NOTE: Cramer's rule for A x = -b.
+          double r[3] = { -q.b[0], -q.b[1], -q.b[2] };
+          auto x = (r[0] * (a[3] * a[5] - a[4] * a[4]) - a[1] * (r[1] * a[5] - a[4] * r[2]) + a[2] * (r[1] * a[4] - a[3] * r[2])) / det;
+          auto y = (a[0] * (r[1] * a[5] - r[2] * a[4]) - r[0] * (a[1] * a[5] - a[4] * a[2]) + a[2] * (a[1] * r[2] - r[1] * a[2])) / det;
+          auto z = (a[0] * (a[3] * r[2] - a[4] * r[1]) - a[1] * (a[1] * r[2] - r[1] * a[2]) + r[0] * (a[1] * a[4] - a[3] * a[2])) / det;
+          auto target = Point3D(x, y, z);
+          //NOTE: A minimum far away from the edge comes from nearly parallel planes and would pull the vertex across the mesh.
+          if(glm::length(target - hpreal(0.5) * (p0 + p1)) <= 2 * glm::length(p1 - p0)) return target;
+     }
+     auto best = p0;
+     for(auto& p : { p1, hpreal(0.5) * (p0 + p1) }) if(q.evaluate(p) < q.evaluate(best)) best = p;
+     return best;
+}
+
+std::vector<LodLevel> make_lod_levels(const TriangleMesh<VertexP3>& mesh, hpuint nMinTriangles, hpuint nMaxLevels) {
+     TraceZone zone("level of detail");
+     auto levels = std::vector<LodLevel>();
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     if(vertices.empty()) return levels;
+
+     //NOTE: The points of the finest level are about as far apart as the vertices if they are spread evenly over the surface.
+     auto area = 0.0;
+     for(auto i = std::size_t(0); i + 2 < indices.size(); i += 3) area += 0.5 * glm::length(glm::cross(vertices[indices[i + 1]].position - vertices[indices[i]].position, vertices[indices[i + 2]].position - vertices[indices[i]].position));
+     auto spacing = hpreal(std::sqrt(area / vertices.size()));
+     if(!(spacing > 0)) return levels;
+
+     auto* previous = &mesh;
+     auto nPoints = vertices.size();
+     while(levels.size() < nMaxLevels) {
+          auto nTriangles = hpuint(previous->getIndices().size() / 12);
+          if(nTriangles < nMinTriangles) break;
+          auto simplified = simplify(*previous, nTriangles);
+          if(4 * simplified.getIndices().size() > 3 * previous->getIndices().size()) break;//NOTE: The mesh cannot be simplified much further.
+
+          //NOTE: Doubling the cell size leaves about a quarter of the points on a surface; it is doubled again if the clusters do not shrink as much.
+          auto points = std::vector<VertexP3>();
+          do {
+               spacing *= 2;
+               points = make_point_clusters(vertices, spacing);
+          } while(points.size() > 1 && 2 * points.size() > nPoints);
+          nPoints = points.size();
+
+          levels.push_back({ std::move(simplified), std::move(points), spacing });
+          previous = &levels.back().mesh;
+     }
+     return levels;
+}
+
+std::vector<VertexP3> make_point_clusters(const std::vector<VertexP3>& points, hpreal cellSize) {
+     struct Cluster {
+          Vector3D sum;
+          hpuint n;
+
+     };//Cluster
+
+     auto clusters = std::unordered_map<std::uint64_t, Cluster>();
+     clusters.reserve(points.size() / 4);
+     for(auto& point : points) {
+          auto cell = glm::floor(point.position / cellSize);
+          auto key = (std::uint64_t(std::int64_t(cell.x) & 0x1fffff) << 42) | (std::uint64_t(std::int64_t(cell.y) & 0x1fffff) << 21) | std::uint64_t(std::int64_t(cell.z) & 0x1fffff);
+          auto& cluster = clusters[key];
+          cluster.sum += point.position;
+          ++cluster.n;
+     }
+     auto clustered = std::vector<VertexP3>();
+     clustered.reserve(clusters.size());
+     for(auto& entry : clusters) clustered.push_back(VertexP3(Point3D(entry.second.sum / hpreal(entry.second.n))));
+     return clustered;
+}
+
+TriangleMesh<VertexP3> simplify(const TriangleMesh<VertexP3>& mesh, hpuint nTriangles) {
+     auto& indices = mesh.getIndices();
+     auto nVertices = hpuint(mesh.getVertices().size());
+     auto positions = std::vector<Point3D>();
+     positions.reserve(nVertices);
+     for(auto& vertex : mesh.getVertices()) positions.push_back(vertex.position);
+
+     auto triangles = std::vector<std::array<hpuint, 3> >(indices.size() / 3);
+     for(auto t = std::size_t(0); t < triangles.size(); ++t) triangles[t] = {{ indices[3 * t], indices[3 * t + 1], indices[3 * t + 2] }};
+     auto alive = std::vector<bool>(triangles.size(), true);
+     auto nAlive = hpuint(triangles.size());
+
+     auto quadrics = std::vector<Quadric>(nVertices);
+     auto fans = std::vector<std::vector<hpuint> >(nVertices);//triangles per vertex
+     for(auto t = hpuint(0); t < triangles.size(); ++t) {
+          auto& triangle = triangles[t];
+          auto quadric = make_quadric(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+          for(auto v : triangle) {
+               quadrics[v].add(quadric);
+               fans[v].push_back(t);
+          }
+     }
+
+     auto stamps = std::vector<hpuint>(nVertices, 0);//NOTE: A collapse in the queue is stale if the stamp of one of its vertices changed.
+     auto removed = std::vector<bool>(nVertices, false);
+     auto queue = std::priority_queue<Collapse>();
+     auto push = [&](hpuint u, hpuint v) {
+          auto quadric = quadrics[u];
+          quadric.add(quadrics[v]);
+          auto target = make_target(quadric, positions[u], positions[v]);
+          queue.push({ quadric.evaluate(target), u, v, stamps[u], stamps[v], target });
+     };
+     //NOTE: Every edge, including the boundary edges that only one triangle has, is pushed once with its smaller vertex first.
+     auto edges = std::vector<std::uint64_t>();
+     edges.reserve(3 * triangles.size());
+     for(auto& triangle : triangles) for(auto i = 0; i < 3; ++i) {
+          auto u = triangle[i];
+          auto v = triangle[(i + 1) % 3];
+          edges.push_back((std::uint64_t(std::min(u, v)) << 32) | std::max(u, v));
+     }
+     std::sort(std::begin(edges), std::end(edges));
+     edges.erase(std::unique(std::begin(edges), std::end(edges)), std::end(edges));
+     for(auto edge : edges) push(hpuint(edge >> 32), hpuint(edge & 0xffffffff));
+
+     auto neighbors = [&](hpuint v, std::vector<hpuint>& result) {
+          result.clear();
+          for(auto t : fans[v]) for(auto w : triangles[t]) if(w != v) result.push_back(w);
+          std::sort(std::begin(result), std::end(result));
+          result.erase(std::unique(std::begin(result), std::end(result)), std::end(result));
+     };
+
+     //NOTE: Returns false if moving the vertex to the target flips or degenerates one of its triangles that does not contain other.
+     auto keepsOrientation = [&](hpuint v, hpuint other, const Point3D& target) {
+          for(auto t : fans[v]) {
+               auto& triangle = triangles[t];
+               if(std::find(std::begin(triangle), std::end(triangle), other) != std::end(triangle)) continue;
+               Point3D before[3], after[3];
+               for(auto i = 0; i < 3; ++i) {
+                    before[i] = positions[triangle[i]];
+                    after[i] = (triangle[i] == v) ? target : before[i];
+               }
+               auto n0 = glm::cross(before[1] - before[0], before[2] - before[0]);
+               auto n1 = glm::cross(after[1] - after[0], after[2] - after[0]);
+               if(glm::dot(n0, n1) <= hpreal(0.2) * glm::length(n0) * glm::length(n1)) return false;
+          }
+          return true;
+     };
+
+     auto neighborsU = std::vector<hpuint>();
+     auto neighborsV = std::vector<hpuint>();
+     auto common = std::vector<hpuint>();
+     while(nAlive > nTriangles && !queue.empty()) {
+          auto collapse = queue.top();
+          queue.pop();
+          auto u = collapse.u;
+          auto v = collapse.v;
+          if(removed[u] || removed[v] || stamps[u] != collapse.stampU || stamps[v] != collapse.stampV) continue;
+
+          //NOTE: The link condition: the vertices of the edge may only share the neighbors opposite to the edge in its triangles.
+          auto nShared = hpuint(std::count_if(std::begin(fans[u]), std::end(fans[u]), [&](hpuint t) { return std::find(std::begin(triangles[t]), std::end(triangles[t]), v) != std::end(triangles[t]); }));
+          neighbors(u, neighborsU);
+          neighbors(v, neighborsV);
+          common.clear();
+          std::set_intersection(std::begin(neighborsU), std::end(neighborsU), std::begin(neighborsV), std::end(neighborsV), std::back_inserter(common));
+          if(nShared == 0 || common.size() != nShared) continue;
+          if(!keepsOrientation(u, v, collapse.target) || !keepsOrientation(v, u, collapse.target)) continue;
+
+          for(auto t : fans[u]) {
+               auto& triangle = triangles[t];
+               if(std::find(std::begin(triangle), std::end(triangle), v) != std::end(triangle)) {
+                    alive[t] = false;
+                    --nAlive;
+                    for(auto w : triangle) if(w != u && w != v) fans[w].erase(std::remove(std::begin(fans[w]), std::end(fans[w]), t), std::end(fans[w]));
+               } else {
+                    std::replace(std::begin(triangle), std::end(triangle), u, v);
+                    fans[v].push_back(t);
+               }
+          }
+          fans[v].erase(std::remove_if(std::begin(fans[v]), std::end(fans[v]), [&](hpuint t) { return !alive[t]; }), std::end(fans[v]));
+          fans[u].clear();
+          removed[u] = true;
+          positions[v] = collapse.target;
+          quadrics[v].add(quadrics[u]);
+          ++stamps[v];
+          neighbors(v, neighborsV);
+          for(auto w : neighborsV) push(v, w);
+     }
+
+     auto remap = std::vector<hpuint>(nVertices, std::numeric_limits<hpuint>::max());
+     auto vertices = std::vector<VertexP3>();
+     auto result = Indices();
+     result.reserve(3 * nAlive);
+     for(auto t = std::size_t(0); t < triangles.size(); ++t) {
+          if(!alive[t]) continue;
+          for(auto v : triangles[t]) {
+               if(remap[v] == std::numeric_limits<hpuint>::max()) {
+                    remap[v] = hpuint(vertices.size());
+                    vertices.push_back(VertexP3(positions[v]));
+               }
+               result.push_back(remap[v]);
+          }
+     }
+     return TriangleMesh<VertexP3>(std::move(vertices), std::move(result));
+}
+
+}//namespace happah
+
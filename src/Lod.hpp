@@ -0,0 +1,38 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+struct LodLevel;
+
+//NOTE: Returns the levels of detail coarser than the mesh, each with about a quarter of the triangles and points of the previous one, down to about nMinTriangles triangles and at most nMaxLevels levels.  The triangles of a level are simplified from the previous level; its points are clustered from the vertices of the mesh.
+std::vector<LodLevel> make_lod_levels(const TriangleMesh<VertexP3>& mesh, hpuint nMinTriangles = 256, hpuint nMaxLevels = 8);
+
+//NOTE: Replaces every nonempty cell of a grid with the given cell size by the average of the points in it.
+std::vector<VertexP3> make_point_clusters(const std::vector<VertexP3>& points, hpreal cellSize);
+
+//NOTE: Collapses the edges of the mesh with the smallest quadric error until at most nTriangles triangles are left.  A collapse that flips a triangle or joins two vertices that share more neighbors than the edge has triangles is skipped, so the result stays manifold where the input is.
+TriangleMesh<VertexP3> simplify(const TriangleMesh<VertexP3>& mesh, hpuint nTriangles);
+
+//DEFINITIONS
+
+struct LodLevel {
+     TriangleMesh<VertexP3> mesh;
+     std::vector<VertexP3> points;
+     hpreal spacing;//cell size of the point clusters
+
+};//LodLevel
+
+}//namespace happah
+
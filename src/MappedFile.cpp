@@ -0,0 +1,41 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.hpp"
+
+namespace happah {
+
+MappedFile::MappedFile(const std::string& path)
+     : m_data(nullptr), m_size(0) {
+     auto descriptor = open(path.c_str(), O_RDONLY);
+     if(descriptor < 0) throw std::runtime_error("Failed to open " + path + '.');
+     struct stat status;
+     if(fstat(descriptor, &status) < 0) {
+          close(descriptor);
+          throw std::runtime_error("Failed to stat " + path + '.');
+     }
+     m_size = std::size_t(status.st_size);
+     if(m_size) {
+          auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+          if(data == MAP_FAILED) {
+               close(descriptor);
+               throw std::runtime_error("Failed to map " + path + '.');
+          }
+          madvise(data, m_size, MADV_SEQUENTIAL);
+          m_data = (const char*)data;
+     }
+     close(descriptor);
+}
+
+MappedFile::~MappedFile() { if(m_data) munmap((void*)m_data, m_size); }
+
+}//namespace happah
+
@@ -0,0 +1,38 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <cstddef>
+#include <string>
+
+namespace happah {
+
+//NOTE: Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+     MappedFile(const std::string& path);
+
+     MappedFile(const MappedFile& file) = delete;
+
+     ~MappedFile();
+
+     MappedFile& operator=(const MappedFile& file) = delete;
+
+     const char* begin() const { return m_data; }
+
+     const char* end() const { return m_data + m_size; }
+
+     std::size_t getSize() const { return m_size; }
+
+private:
+     const char* m_data;
+     std::size_t m_size;
+
+};//MappedFile
+
+}//namespace happah
+
@@ -0,0 +1,298 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <type_traits>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "MeshFile.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+static_assert(std::is_trivially_copyable<VertexP3>::value, "The mesh cache stores vertices as raw bytes.");
+
+//NOTE: The cache consists of this header followed by the vertex and the index array, each starting at a multiple of 64 bytes.
+struct CacheHeader {
+     char magic[8];
+     std::uint32_t version;
+     std::uint32_t vertexSize;
+     std::uint32_t indexSize;
+     std::uint32_t reserved;
+     std::uint64_t sourceSize;
+     std::int64_t sourceTime;//nanoseconds
+     std::uint64_t nVertices;
+     std::uint64_t nIndices;
+
+};//CacheHeader
+
+static constexpr char CACHE_MAGIC[8] = { 'H', 'A', 'P', 'P', 'A', 'H', 'M', 'C' };
+static constexpr std::uint32_t CACHE_VERSION = 1;
+
+static std::uint64_t align(std::uint64_t offset) { return (offset + 63) & ~std::uint64_t(63); }
+
+static std::uint64_t get_indices_offset(std::uint64_t nVertices) { return align(align(sizeof(CacheHeader)) + nVertices * sizeof(VertexP3)); }
+
+static bool is_comment(char c) { return c == '#'; }
+
+static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+//NOTE: Returns the beginning of the next line or end.
+static const char* find_line(const char* i, const char* end) {
+     auto line = (const char*)std::memchr(i, '\n', end - i);
+     return (line) ? line + 1 : end;
+}
+
+//NOTE: Returns true if the line starting at i contains data, that is, it is neither empty nor a comment.
+static bool is_record(const char* i, const char* end) {
+     while(i != end && is_space(*i)) ++i;
+     return i != end && *i != '\n' && !is_comment(*i);
+}
+
+static hpuint parse_index(const char*& i, const char* end) {
+     while(i != end && is_space(*i)) ++i;
+     if(i == end || *i < '0' || *i > '9') throw std::runtime_error("Expected an integer.");
+     auto value = std::uint64_t(0);
+     while(i != end && *i >= '0' && *i <= '9') value = 10 * value + (*i++ - '0');
+     return hpuint(value);
+}
+
+static double to_real(const char* text, char** end, double) { return std::strtod(text, end); }
+
+static float to_real(const char* text, char** end, float) { return std::strtof(text, end); }
+
+//NOTE: The token is copied so that it is null-terminated; the mapped file is not.  Parsing it with strtod or strtof rounds it correctly, so that a written mesh is read back exactly, and accepts inf and nan.
+static hpreal parse_real(const char*& i, const char* end) {
+     while(i != end && is_space(*i)) ++i;
+     auto last = i;
+     while(last != end && !is_space(*last) && *last != '\n' && !is_comment(*last)) ++last;
+     auto size = std::size_t(last - i);
+     if(size == 0) throw std::runtime_error("Expected a number.");
+     char buffer[64];
+     auto token = std::string();//if the token does not fit into the buffer
+     auto text = (const char*)buffer;
+     if(size < sizeof(buffer)) {
+          std::memcpy(buffer, i, size);
+          buffer[size] = '\0';
+     } else {
+          token.assign(i, last);
+          text = token.c_str();
+     }
+     auto stop = (char*)nullptr;
+     auto value = to_real(text, &stop, hpreal());
+     if(stop != text + size) throw std::runtime_error("Expected a number.");
+     i = last;
+     return value;
+}
+
+//NOTE: Skips whitespace and comments across lines.
+static const char* skip(const char* i, const char* end) {
+     while(i != end) {
+          if(is_comment(*i)) i = find_line(i, end);
+          else if(is_space(*i) || *i == '\n') ++i;
+          else break;
+     }
+     return i;
+}
+
+static TriangleMesh<VertexP3> parse(const std::string& path, const MappedFile& file, hpuint nThreads) {
+     auto begin = file.begin();
+     auto end = file.end();
+     auto i = skip(begin, end);
+
+     if(end - i < 3 || std::strncmp(i, "OFF", 3) != 0) throw std::runtime_error(path + " is not an OFF file.");
+     i = skip(i + 3, end);
+     auto nVertices = parse_index(i, end);
+     i = skip(i, end);
+     auto nFaces = parse_index(i, end);
+     i = skip(i, end);
+     parse_index(i, end);//number of edges
+     i = find_line(i, end);
+
+     auto nChunks = std::size_t(4 * nThreads);
+     auto boundaries = std::vector<const char*>(nChunks + 1, end);
+     boundaries[0] = i;
+     for(auto c = std::size_t(1); c < nChunks; ++c) boundaries[c] = find_line(std::max(boundaries[c - 1], i + (end - i) * c / nChunks), end);
+
+     ThreadPool pool(nThreads);
+
+     //NOTE: The first pass counts the records in every chunk so that the second pass knows which records are vertices and which are faces.
+     auto counts = std::vector<std::future<std::size_t> >();
+     counts.reserve(nChunks);
+     for(auto c = std::size_t(0); c < nChunks; ++c) counts.push_back(pool.submit([&, c]() {
+          TraceZone zone("count records");
+          auto n = std::size_t(0);
+          for(auto j = boundaries[c], e = boundaries[c + 1]; j != e; j = find_line(j, e)) if(is_record(j, e)) ++n;
+          return n;
+     }));
+     auto offsets = std::vector<std::size_t>(nChunks + 1, 0);
+     for(auto c = std::size_t(0); c < nChunks; ++c) offsets[c + 1] = offsets[c] + counts[c].get();
+     if(offsets[nChunks] < std::size_t(nVertices) + nFaces) throw std::runtime_error("Unexpected end of " + path + '.');
+
+     auto vertices = std::vector<VertexP3>(nVertices);
+     auto faces = std::vector<std::future<Indices> >();
+     faces.reserve(nChunks);
+     for(auto c = std::size_t(0); c < nChunks; ++c) faces.push_back(pool.submit([&, c]() {
+          TraceZone zone("parse records");
+          auto indices = Indices();
+          auto r = offsets[c];
+          auto j = boundaries[c];
+          auto e = boundaries[c + 1];
+          while(j != e && r < std::size_t(nVertices) + nFaces) {
+               auto line = find_line(j, e);
+               if(is_record(j, e)) try {
+                    if(r < nVertices) {
+                         auto x = parse_real(j, line);
+                         auto y = parse_real(j, line);
+                         auto z = parse_real(j, line);
+                         vertices[r] = VertexP3(Point3D(x, y, z));
+                    } else {
+                         auto n = parse_index(j, line);
+                         if(n < 3) throw std::runtime_error("Expected a polygon.");
+                         auto i0 = parse_index(j, line);
+                         auto i1 = parse_index(j, line);
+                         for(auto k = hpuint(2); k < n; ++k) {
+                              auto i2 = parse_index(j, line);
+                              if(i0 >= nVertices || i1 >= nVertices || i2 >= nVertices) throw std::runtime_error("Index out of range.");
+                              indices.insert(std::end(indices), { i0, i1, i2 });
+                              i1 = i2;
+                         }
+                    }
+                    ++r;
+               } catch(std::exception& exception) {
+                    throw std::runtime_error("Failed to parse record " + std::to_string(r) + " of " + path + ": " + exception.what());
+               }
+               j = line;
+          }
+          return indices;
+     }));
+     auto chunks = std::vector<Indices>();
+     auto nIndices = std::size_t(0);
+     chunks.reserve(nChunks);
+     for(auto& f : faces) {
+          chunks.push_back(f.get());
+          nIndices += chunks.back().size();
+     }
+     auto indices = Indices();
+     indices.reserve(nIndices);
+     for(auto& chunk : chunks) indices.insert(std::end(indices), std::begin(chunk), std::end(chunk));
+
+     return TriangleMesh<VertexP3>(std::move(vertices), std::move(indices));
+}
+
+static bool read_cache(const std::string& path, const struct stat& source, std::vector<VertexP3>& vertices, Indices& indices) {
+     struct stat status;
+     if(stat(path.c_str(), &status) < 0 || std::size_t(status.st_size) < sizeof(CacheHeader)) return false;
+     MappedFile file(path);
+     auto header = CacheHeader();
+     std::memcpy(&header, file.begin(), sizeof(header));
+     if(std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION) return false;
+     if(header.vertexSize != sizeof(VertexP3) || header.indexSize != sizeof(hpindex)) return false;
+     if(header.sourceSize != std::uint64_t(source.st_size) || header.sourceTime != std::int64_t(source.st_mtim.tv_sec) * 1000000000 + source.st_mtim.tv_nsec) return false;
+     auto offset = get_indices_offset(header.nVertices);
+     if(file.getSize() != offset + header.nIndices * sizeof(hpindex)) return false;
+     vertices.resize(header.nVertices);
+     indices.resize(header.nIndices);
+     std::memcpy(vertices.data(), file.begin() + align(sizeof(CacheHeader)), header.nVertices * sizeof(VertexP3));
+     std::memcpy(indices.data(), file.begin() + offset, header.nIndices * sizeof(hpindex));
+     return true;
+}
+
+//NOTE: The cache is written to a temporary file first so that concurrent viewers never see a partial cache.
+static void write_cache(const std::string& path, const struct stat& source, const TriangleMesh<VertexP3>& mesh) {
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     auto header = CacheHeader();
+     std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+     header.version = CACHE_VERSION;
+     header.vertexSize = sizeof(VertexP3);
+     header.indexSize = sizeof(hpindex);
+     header.sourceSize = std::uint64_t(source.st_size);
+     header.sourceTime = std::int64_t(source.st_mtim.tv_sec) * 1000000000 + source.st_mtim.tv_nsec;
+     header.nVertices = vertices.size();
+     header.nIndices = indices.size();
+
+     static const char zeros[64] = {};
+     auto temporary = path + ".tmp";
+     std::ofstream stream(temporary, std::ios::binary);
+     stream.write((const char*)&header, sizeof(header));
+     stream.write(zeros, align(sizeof(header)) - sizeof(header));
+     stream.write((const char*)vertices.data(), vertices.size() * sizeof(VertexP3));
+     stream.write(zeros, get_indices_offset(vertices.size()) - align(sizeof(header)) - vertices.size() * sizeof(VertexP3));
+     stream.write((const char*)indices.data(), indices.size() * sizeof(hpindex));
+     stream.close();
+     if(!stream || std::rename(temporary.c_str(), path.c_str()) != 0) {
+          std::remove(temporary.c_str());
+          std::cerr << "WARNING: Failed to write mesh cache " << path << ".\n";
+     }
+}
+
+std::vector<std::pair<hpuint, hpuint> > make_changed_ranges(const std::vector<VertexP3>& vertices0, const std::vector<VertexP3>& vertices1, hpuint gap) {
+     auto ranges = std::vector<std::pair<hpuint, hpuint> >();
+     auto n = hpuint(std::min(vertices0.size(), vertices1.size()));
+     for(auto i = hpuint(0); i < n; ++i) {
+          if(std::memcmp(&vertices0[i], &vertices1[i], sizeof(VertexP3)) == 0) continue;
+          if(!ranges.empty() && i - ranges.back().second < gap) ranges.back().second = i + 1;
+          else ranges.emplace_back(i, i + 1);
+     }
+     return ranges;
+}
+
+TriangleMesh<VertexP3> read_triangle_mesh(const std::string& path, bool cache, hpuint nThreads) {
+     struct stat source;
+     if(stat(path.c_str(), &source) < 0) throw std::runtime_error("Failed to open " + path + '.');
+     auto cachePath = path + ".cache";
+     TraceZone zone("import");
+
+     if(cache) {
+          auto vertices = std::vector<VertexP3>();
+          auto indices = Indices();
+          if(read_cache(cachePath, source, vertices, indices)) {
+               std::cout << "INFO: Read mesh cache " << cachePath << '.' << std::endl;
+               return TriangleMesh<VertexP3>(std::move(vertices), std::move(indices));
+          }
+     }
+
+     auto mesh = parse(path, MappedFile(path), std::max(1u, nThreads));
+     if(cache) {
+          TraceZone zone("write mesh cache");
+          write_cache(cachePath, source, mesh);
+     }
+     return mesh;
+}
+
+void write_triangle_mesh(const std::string& path, const TriangleMesh<VertexP3>& mesh, bool cache) {
+     TraceZone zone("export");
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     {
+          std::ofstream stream(path);
+          if(!stream) throw std::runtime_error("Failed to open " + path + '.');
+          stream << "OFF\n" << vertices.size() << ' ' << indices.size() / 3 << " 0\n" << std::setprecision(std::numeric_limits<hpreal>::max_digits10);
+          for(auto& vertex : vertices) stream << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n';
+          for(auto i = std::begin(indices), end = std::end(indices); i != end; i += 3) stream << "3 " << i[0] << ' ' << i[1] << ' ' << i[2] << '\n';
+          zone.addBytes(std::size_t(stream.tellp()));
+          if(!stream) throw std::runtime_error("Failed to write " + path + '.');
+     }
+     if(!cache) return;
+     struct stat source;
+     if(stat(path.c_str(), &source) < 0) throw std::runtime_error("Failed to open " + path + '.');
+     write_cache(path + ".cache", source, mesh);
+}
+
+}//namespace happah
+
@@ -0,0 +1,31 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+//NOTE: Returns the ranges [begin, end) of the vertices in which two meshes with the same number of vertices differ.  Ranges that are less than gap vertices apart are merged so that a few larger buffer updates are made instead of many small ones.
+std::vector<std::pair<hpuint, hpuint> > make_changed_ranges(const std::vector<VertexP3>& vertices0, const std::vector<VertexP3>& vertices1, hpuint gap = 64);
+
+//NOTE: Reads a triangle mesh from an OFF file by memory-mapping it and parsing chunks of it in parallel on the given number of threads; polygons are split into triangle fans.  If cache is true, the mesh is read from or written to a binary sidecar file (path + ".cache") that is valid as long as the size and modification time of the OFF file do not change.
+TriangleMesh<VertexP3> read_triangle_mesh(const std::string& path, bool cache = true, hpuint nThreads = std::max(1u, std::thread::hardware_concurrency()));
+
+//NOTE: Writes the mesh to an OFF file.  If cache is true, the binary sidecar file that read_triangle_mesh reads instead of parsing the OFF file is written as well.
+void write_triangle_mesh(const std::string& path, const TriangleMesh<VertexP3>& mesh, bool cache = true);
+
+}//namespace happah
+
@@ -0,0 +1,440 @@
+// Copyright 2017
+//   Pawel Herman   - Karlsruhe Institute of Technology - pherman@ira.uka.de
+//   Hedwig Amberg  - Karlsruhe Institute of Technology - hedwigdorothea@gmail.com
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <happah/geometry/BezierTriangleMesh.hpp>
+#include <happah/geometry/LoopBoxSplineMesh.hpp>
+#include <happah/geometry/TriangleArray.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "CompactColors.hpp"
+#include "Lod.hpp"
+#include "MeshFile.hpp"
+#include "MeshPanels.hpp"
+#include "Meshlets.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+template<class T>
+static std::shared_ptr<T> to_shared(T value) { return std::make_shared<T>(std::move(value)); }
+
+template<class T>
+static bool is_ready(const std::future<T>& future) { return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+template<class Data>
+static std::unique_ptr<Buffer> make_traced_buffer(const Data& data) {
+     TraceZone zone("upload buffer");
+     zone.addBytes(data.size() * sizeof(data[0]));
+     return std::make_unique<Buffer>(make_buffer(data));
+}
+
+static std::string describe(const Pick& pick) {
+     switch(pick.type) {
+     case Pick::Type::VERTEX: return "vertex " + std::to_string(pick.index);
+     case Pick::Type::EDGE: return "edge " + std::to_string(pick.index);
+     case Pick::Type::TRIANGLE: return "triangle " + std::to_string(pick.index);
+     }
+     return std::string();
+}
+
+static std::vector<hpcolor> make_triangle_colors(hpuint nTriangles) {
+     auto blue = hpcolor(0.0, 0.0, 1.0, 1.0);
+     auto green = hpcolor(0.0, 1.0, 0.0, 1.0);
+     auto red = hpcolor(1.0, 0.0, 0.0, 1.0);
+     auto triangleColors = std::vector<hpcolor>(3 * nTriangles, blue);
+
+     //TODO: only for testing !!!
+     for(int i = 0; i < size(triangleColors); i += 3){
+          triangleColors[i] = red;
+          triangleColors[i+1] = blue;
+          triangleColors[i+2] = green;
+     }
+     return triangleColors;
+}
+
+//NOTE: Returns the edge and vertex colors of the corners, which mark the seams of a cut of the graph.
+static std::tuple<std::vector<hpcolor>, std::vector<hpcolor> > make_seam_colors(const TriangleGraph<VertexP3>& graph, hpuint nTriangles) {
+     auto green = hpcolor(0.0, 1.0, 0.0, 1.0);
+     auto red = hpcolor(1.0, 0.0, 0.0, 1.0);
+     auto edgeColors = std::vector<hpcolor>(3 * nTriangles, green); //std::vector<hpcolor>(3 * nTriangles, blue);
+     auto vertexColors = std::vector<hpcolor>(3 * nTriangles, red); //std::vector<hpcolor>(3 * nTriangles, blue);
+
+     for(auto e : trim(graph, cut(graph))){
+          edgeColors[e] = red;
+          visit_spokes(make_spokes_enumerator(graph.getEdges(), e), [&](auto e) {
+               static constexpr hpuint o[3] = { 1, 2, 0 };
+
+               auto f = graph.getEdge(e).opposite;
+               auto t = make_triangle_index(f);
+               auto i = make_edge_offset(f);
+               vertexColors[3 * t + o[i]] = red;
+               vertexColors[e] = red;
+          });
+     }
+     return std::make_tuple(std::move(edgeColors), std::move(vertexColors));
+}
+
+template<class Task>
+void MeshPanels::request(const std::string& name, Task task) { if(m_requested.insert(name).second) m_jobs.push_back(m_pool.submit(task)); }
+
+template<class Task>
+void MeshPanels::requestWithGraph(const std::string& name, Task task) {
+     if(m_requested.count(name)) return;
+     if(!m_graph.valid()) m_graph = m_pool.submit([&]() {
+          TraceZone zone("triangle graph");
+          return make_triangle_graph(m_mesh);
+     }).share();
+     auto graph = m_graph;
+     request(name, [task, graph]() { return task(graph.get()); });
+}
+
+MeshPanels::MeshPanels(const Options& options, PanelRenderer& renderer, std::function<void()> notify)
+     : m_hoveredPick(-1, 0, 0), m_mesh(read_triangle_mesh(options.paths[0], options.cache)), m_notify(std::move(notify)), m_options(options), m_palette({ hpcolor(0.0, 0.0, 1.0, 1.0), hpcolor(0.0, 1.0, 0.0, 1.0), hpcolor(1.0, 0.0, 0.0, 1.0) }), m_pool(std::max(1u, std::thread::hardware_concurrency()), m_notify), m_queue(renderer.getVertexArray()), m_renderer(renderer) {
+     m_box = make_axis_aligned_bounding_box(m_mesh);
+     m_buffers.nPoints = hpuint(m_mesh.getNumberOfVertices());
+     m_buffers.nTriangles = hpuint(size(m_mesh));
+}
+
+MeshPanels::~MeshPanels() {}
+
+void MeshPanels::enablePicking() {
+     m_picking = true;
+     request("bounding volume hierarchy", [&]() {
+          auto hierarchy = to_shared(make_bvh(m_mesh));
+          return std::function<void()>([&, hierarchy]() {
+               m_bvh = std::make_unique<Bvh>(std::move(*hierarchy));
+               std::cout << "INFO: Picking is enabled; the bounding volume hierarchy has " << m_bvh->getNodes().size() << " nodes." << std::endl;
+          });
+     });
+}
+
+Vector3D MeshPanels::getOffset(Panel panel) const {
+     auto lengths = std::get<1>(m_box) - std::get<0>(m_box);
+     return make_panel_offset(panel, lengths, hpreal(0.1) * lengths);
+}
+
+//NOTE: A highlight overwrites a few entries of the per-corner edge and vertex color buffers and their copies and remembers the colors it overwrote.  Highlights are undone in the reverse order in which they were made.
+void MeshPanels::highlight(Highlight& entries, const Pick& pick, const hpcolor& color) {
+     auto& b = m_buffers;
+     if(!b.be3 || !b.bc3) return;
+     auto write = [&](GLuint buffer, std::vector<hpcolor>& colors, hpuint corner) {
+          entries.emplace_back(buffer, corner, colors[corner]);
+          colors[corner] = color;
+          glBindBuffer(GL_ARRAY_BUFFER, buffer);
+          glBufferSubData(GL_ARRAY_BUFFER, corner * sizeof(hpcolor), sizeof(hpcolor), &color);
+     };
+     switch(pick.type) {
+     case Pick::Type::VERTEX: write(b.bc3->getId(), b.cc3, 3 * pick.triangle + pick.corner); break;
+     case Pick::Type::EDGE: write(b.be3->getId(), b.ce3, 3 * pick.triangle + pick.corner); break;
+     case Pick::Type::TRIANGLE: for(auto i = hpuint(0); i < 3; ++i) write(b.be3->getId(), b.ce3, 3 * pick.triangle + i); break;
+     }
+     glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool MeshPanels::pick(const Viewport& viewport, const Point2D& cursor, const Panels& panels, bool clicked) {
+     if(!m_bvh) return false;
+     auto inverse = glm::inverse(make_projection_matrix(viewport) * make_view_matrix(viewport));
+     auto x = hpreal(2) * cursor.x / hpreal(viewport.getWidth()) - hpreal(1);
+     auto y = hpreal(2) * cursor.y / hpreal(viewport.getHeight()) - hpreal(1);
+     auto near = inverse * Point4D(x, y, -1.0, 1.0);
+     auto far = inverse * Point4D(x, y, 1.0, 1.0);
+     auto origin = Point3D(near) / near.w;
+     auto direction = Point3D(far) / far.w - origin;
+     auto hit = Hit();
+     for(auto panel : { Panel::MESH, Panel::TRIANGLE_ARRAY, Panel::POINT_CLOUD, Panel::WIREFRAME, Panel::TRIANGLE_COLORS, Panel::EDGES, Panel::PATCHES }) {
+          if(!panels[panel]) continue;
+          auto candidate = m_bvh->intersect(m_mesh, origin - getOffset(panel), direction);
+          if(candidate.t < hit.t) hit = candidate;
+     }
+
+     auto picked = hit ? make_pick(m_mesh, hit) : Pick();
+     auto key = hit ? std::make_tuple(int(picked.type), picked.triangle, picked.corner) : std::make_tuple(-1, hpuint(0), hpuint(0));
+     if(key == m_hoveredPick && !clicked) return false;
+     unhighlight(m_hovered);
+     if(clicked) {
+          unhighlight(m_selected);
+          if(hit) {
+               highlight(m_selected, picked, hpcolor(1.0, 1.0, 1.0, 1.0));
+               std::cout << "INFO: Picked " << describe(picked) << " of triangle " << hit.triangle << '.' << std::endl;
+          }
+     }
+     if(hit) highlight(m_hovered, picked, hpcolor(1.0, 1.0, 0.0, 1.0));
+     m_hoveredPick = key;
+     m_pickStatus = hit ? describe(picked) : std::string();
+     return true;
+}
+
+//NOTE: If only the positions changed, the changed ranges of the vertex buffers are overwritten and the hierarchy is refit; the surfaces that depend on the positions are made again from the same topology while the seams and colors are kept.  If the topology changed, everything that was derived from the mesh is made again.
+bool MeshPanels::reload() {
+     auto next = std::unique_ptr<TriangleMesh<VertexP3> >();
+     try {
+          next = std::make_unique<TriangleMesh<VertexP3> >(read_triangle_mesh(m_options.paths[0], m_options.cache));
+     } catch(std::exception& e) {
+          std::cerr << "WARNING: Keeping the previous mesh: " << e.what() << std::endl;
+          return false;
+     }
+     //NOTE: The tasks and the graph read the mesh.
+     if(m_graph.valid()) m_graph.wait();
+     wait();
+
+     auto& b = m_buffers;
+     auto& indices = m_mesh.getIndices();
+     if(next->getVertices().size() == m_mesh.getVertices().size() && next->getIndices() == indices) {
+          auto ranges = make_changed_ranges(m_mesh.getVertices(), next->getVertices());
+          auto write = [&](Buffer& buffer, const std::vector<VertexP3>& vertices, const std::vector<std::pair<hpuint, hpuint> >& ranges) {
+               glBindBuffer(GL_ARRAY_BUFFER, buffer.getId());
+               for(auto& range : ranges) glBufferSubData(GL_ARRAY_BUFFER, range.first * sizeof(VertexP3), (range.second - range.first) * sizeof(VertexP3), vertices.data() + range.first);
+               glBindBuffer(GL_ARRAY_BUFFER, 0);
+          };
+          if(b.bv0) write(*b.bv0, next->getVertices(), ranges);
+          if(b.bv3) {
+               auto getCorners = [&](const std::vector<VertexP3>& vertices) {
+                    auto corners = std::vector<VertexP3>();
+                    corners.reserve(indices.size());
+                    for(auto v : indices) corners.push_back(vertices[v]);
+                    return corners;
+               };
+               auto corners = getCorners(next->getVertices());
+               write(*b.bv3, corners, make_changed_ranges(getCorners(m_mesh.getVertices()), corners));
+          }
+          m_mesh = std::move(*next);
+          if(m_bvh) m_bvh->refit(m_mesh);
+          std::cout << "INFO: Updated " << ranges.size() << " ranges of vertices." << std::endl;
+     } else {
+          m_mesh = std::move(*next);
+          b.nPoints = hpuint(m_mesh.getNumberOfVertices());
+          b.nTriangles = hpuint(size(m_mesh));
+          m_hovered.clear();
+          m_selected.clear();
+          m_hoveredPick = std::make_tuple(-1, hpuint(0), hpuint(0));
+          m_pickStatus.clear();
+          for(auto buffer : { &b.bv0, &b.bv1, &b.bv2, &b.bv3, &b.bi0, &b.bi1, &b.bi2, &b.be3, &b.bc3, &b.bt3 }) buffer->reset();
+          b.ce3.clear();
+          b.cc3.clear();
+          for(auto context : { &b.rc0, &b.rc1, &b.rc2 }) context->reset();
+          b.compact.reset();//NOTE: The colors belong to the previous triangles; require makes new ones.
+          m_bvh.reset();
+          b.nBoxPatches = 0;
+          b.nQuinticPatches = 0;
+          m_requested.clear();
+          if(m_picking) enablePicking();
+          std::cout << "INFO: The topology changed; the mesh has " << b.nTriangles << " triangles." << std::endl;
+     }
+     m_box = make_axis_aligned_bounding_box(m_mesh);
+     m_graph = decltype(m_graph)();
+     b.streamer.reset();
+     b.lods.clear();
+     m_meshLevel = m_pointLevel = m_wireframeLevel = 0;
+     for(auto name : { "level of detail", "loop box spline mesh", "meshlets", "quintic spline surface" }) m_requested.erase(name);
+     return true;
+}
+
+void MeshPanels::render(Profiler& profiler, const Viewport& viewport, const Panels& shown) {
+     TraceZone zone("frame");
+     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+     glEnable(GL_DEPTH_TEST);
+
+     auto& b = m_buffers;
+     auto frame = PanelFrame();
+     frame.lower = std::get<0>(m_box);
+     frame.upper = std::get<1>(m_box);
+     frame.projectionMatrix = make_projection_matrix(viewport);
+     frame.viewMatrix = make_view_matrix(viewport);
+     frame.viewportSize = Vector2D(viewport.getWidth(), viewport.getHeight());
+     frame.radius = 0.05;
+     frame.primitives = &m_primitives;
+     auto modelViewMatrices = std::array<glm::mat4, Panels::SIZE>();
+     for(auto i = hpuint(0); i < Panels::SIZE; ++i) {
+          frame.offsets[i] = getOffset(Panel(i));
+          modelViewMatrices[i] = glm::translate(frame.viewMatrix, frame.offsets[i]);
+     }
+     auto panels = m_culler.cull(shown, frame.projectionMatrix, modelViewMatrices, frame.lower, frame.upper);
+
+     auto uniforms = FrameUniforms();
+     uniforms.projectionMatrix = frame.projectionMatrix;
+     uniforms.viewMatrix = frame.viewMatrix;
+     uniforms.light = Vector4D(glm::normalize(Point3D(frame.viewMatrix[0])), 0.0);
+     uniforms.viewportSize = frame.viewportSize;
+     m_queue.beginFrame(uniforms);
+
+     //NOTE: A panel draws the coarsest level that still has about density triangles or points per pixel of its projected bounding rectangle.  It only switches to a coarser level once that level has half again as many as needed, so the level does not flicker while the size hovers around a threshold.
+     auto selectLevel = [&](hpuint& level, Panel panel, auto getCount, hpreal density) {
+          auto size = make_projected_size(frame.lower, frame.upper, frame.projectionMatrix, modelViewMatrices[hpuint(panel)], frame.viewportSize);
+          auto needed = density * hpreal(0.5) * size * size;
+          auto best = hpuint(0);
+          for(auto l = hpuint(b.lods.size()); l > 0; --l) if(hpreal(getCount(l)) >= needed) {
+               best = l;
+               break;
+          }
+          if(best < level || hpreal(getCount(best)) >= hpreal(1.5) * needed) level = best;
+          level = std::min(level, hpuint(b.lods.size()));
+     };
+     selectLevel(m_meshLevel, Panel::MESH, [&](hpuint l) { return (l) ? b.lods[l - 1].nTriangles : b.nTriangles; }, 1.0);
+     selectLevel(m_wireframeLevel, Panel::WIREFRAME, [&](hpuint l) { return (l) ? b.lods[l - 1].nTriangles : b.nTriangles; }, 1.0);
+     selectLevel(m_pointLevel, Panel::POINT_CLOUD, [&](hpuint l) { return (l) ? b.lods[l - 1].nPoints : b.nPoints; }, 0.25);
+     frame.meshLevel = m_meshLevel;
+     frame.pointLevel = m_pointLevel;
+     frame.wireframeLevel = m_wireframeLevel;
+
+     m_renderer.push(m_queue, b, frame, panels);
+     m_queue.submit(profiler);
+     profiler.begin("occlusion queries");
+     m_culler.query();
+     profiler.end();
+}
+
+void MeshPanels::require(const Panels& panels) {
+     auto& b = m_buffers;
+     auto& options = m_options;
+     auto needsColors = panels[Panel::TRIANGLE_COLORS] || panels[Panel::EDGES] || panels[Panel::PATCHES];
+     auto needsMesh = (panels[Panel::MESH] && options.budget == 0) || panels[Panel::POINT_CLOUD] || panels[Panel::WIREFRAME] || (needsColors && options.compact);
+     auto needsTriangles = panels[Panel::TRIANGLE_ARRAY] || (needsColors && !options.compact);
+     auto needsSeams = panels[Panel::EDGES] || panels[Panel::PATCHES];
+     auto needsTriangleColors = panels[Panel::TRIANGLE_COLORS] || panels[Panel::PATCHES];
+     auto& vertexArray = m_renderer.getVertexArray();
+
+     m_renderer.require(panels);
+     if(needsColors && options.compact && !b.compact) b.compact = std::make_unique<CompactColors>(m_palette);
+
+     auto reportSavings = [&](std::size_t before, std::size_t after) {
+          m_savedBytes += before - after;
+          std::cout << "INFO: Compact colors take " << after << " instead of " << before << " bytes; " << m_savedBytes << " bytes saved in total." << std::endl;
+     };
+
+     if(needsMesh && !b.bv0) {
+          b.bv0 = make_traced_buffer(m_mesh.getVertices());
+          b.bi0 = make_traced_buffer(m_mesh.getIndices());
+          b.rc0 = std::make_unique<RenderContext>(make_render_context(vertexArray, *b.bi0, PatchType::TRIANGLE));
+     }
+     //NOTE: With a budget, the mesh panel is drawn from meshlets that are read from a file as they become visible instead of from one vertex buffer.
+     if((panels[Panel::MESH] && options.budget == 0) || panels[Panel::POINT_CLOUD] || panels[Panel::WIREFRAME]) request("level of detail", [&]() {
+          auto levels = to_shared(make_lod_levels(m_mesh));
+          return std::function<void()>([&, levels]() {
+               for(auto& level : *levels) {
+                    auto lod = PanelBuffers::Lod();
+                    lod.vertices = make_traced_buffer(level.mesh.getVertices());
+                    lod.indices = make_traced_buffer(level.mesh.getIndices());
+                    lod.context = std::make_unique<RenderContext>(make_render_context(m_renderer.getVertexArray(), *lod.indices, PatchType::TRIANGLE));
+                    lod.points = make_traced_buffer(level.points);
+                    lod.nPoints = hpuint(level.points.size());
+                    lod.nTriangles = hpuint(size(level.mesh));
+                    lod.spacing = level.spacing;
+                    m_buffers.lods.push_back(std::move(lod));
+               }
+               std::cout << "INFO: Made " << m_buffers.lods.size() << " levels of detail down to " << (m_buffers.lods.empty() ? m_buffers.nTriangles : m_buffers.lods.back().nTriangles) << " triangles." << std::endl;
+          });
+     });
+     if(panels[Panel::MESH] && options.budget > 0) request("meshlets", [&]() {
+          auto file = to_shared(make_meshlet_file(m_options.paths[0], m_mesh, m_options.cache));
+          return std::function<void()>([&, file]() { m_buffers.streamer = std::make_unique<MeshletStreamer>(*file, m_options.budget << 20, m_notify); });
+     });
+     if(needsTriangles) request("triangle array", [&]() {
+          TraceZone zone("triangle array");
+          auto triangles = to_shared(make_triangle_array(m_mesh));
+          return std::function<void()>([&, triangles]() { m_buffers.bv3 = make_traced_buffer(triangles->getVertices()); });
+     });
+     if(needsTriangleColors && !options.compact) request("triangle colors", [&]() {
+          TraceZone zone("triangle colors");
+          auto triangleColors = to_shared(make_triangle_colors(hpuint(size(m_mesh))));
+          return std::function<void()>([&, triangleColors]() { m_buffers.bt3 = make_traced_buffer(*triangleColors); });
+     });
+     if(needsTriangleColors && options.compact) request("compact triangle colors", [&, reportSavings]() {
+          TraceZone zone("triangle colors");
+          auto nTriangles = hpuint(size(m_mesh));
+          auto triangleColors = to_shared(make_compact_colors(m_palette, make_triangle_colors(nTriangles)));
+          return std::function<void()>([&, reportSavings, nTriangles, triangleColors]() {
+               m_buffers.compact->setTriangleColors(*triangleColors);
+               reportSavings(3 * nTriangles * sizeof(hpcolor), triangleColors->size() * sizeof(std::uint32_t));
+          });
+     });
+     if(needsSeams && !options.compact) requestWithGraph("seams", [&](const auto& g) {
+          TraceZone zone("seams");
+          auto colors = to_shared(make_seam_colors(g, hpuint(size(m_mesh))));
+          return std::function<void()>([&, colors]() {
+               m_buffers.be3 = make_traced_buffer(std::get<0>(*colors));
+               m_buffers.bc3 = make_traced_buffer(std::get<1>(*colors));
+               m_buffers.ce3 = std::move(std::get<0>(*colors));
+               m_buffers.cc3 = std::move(std::get<1>(*colors));
+          });
+     });
+     if(needsSeams && options.compact) requestWithGraph("compact seams", [&, reportSavings](const auto& g) {
+          TraceZone zone("seams");
+          auto nTriangles = hpuint(size(m_mesh));
+          auto seamColors = make_seam_colors(g, nTriangles);
+          auto edgeColors = to_shared(make_compact_colors(m_palette, std::get<0>(seamColors)));
+          auto vertexColors = to_shared(make_compact_colors(m_palette, std::get<1>(seamColors)));
+          return std::function<void()>([&, reportSavings, nTriangles, edgeColors, vertexColors]() {
+               m_buffers.compact->setSeamColors(*edgeColors, *vertexColors);
+               reportSavings(2 * 3 * nTriangles * sizeof(hpcolor), 2 * edgeColors->size() * sizeof(std::uint32_t));
+          });
+     });
+     if(panels[Panel::LOOP_BOX_SPLINE]) request("loop box spline mesh", [&]() {
+          TraceZone zone("loop box spline mesh");
+          auto boxes = to_shared(make_loop_box_spline_mesh(m_mesh));
+          return std::function<void()>([&, boxes]() {
+               m_buffers.bv2 = make_traced_buffer(boxes->getControlPoints());
+               m_buffers.bi2 = make_traced_buffer(boxes->getIndices());
+               m_buffers.nBoxPatches = hpuint(size(boxes->getIndices()) / 12);
+               m_buffers.rc2 = std::make_unique<RenderContext>(make_render_context(m_renderer.getVertexArray(), *m_buffers.bi2, PatchType::LOOP_BOX_SPLINE));
+          });
+     });
+     if(panels[Panel::QUINTIC]) requestWithGraph("quintic spline surface", [&](const auto& g) {
+          auto quartic = [&]() {
+               TraceZone zone("spline surface");
+               return make_spline_surface(g);
+          }();
+          //auto mesh = make_triangle_mesh(quartic, 4);
+          auto quintic = [&]() {
+               TraceZone zone("elevate");
+               return to_shared(elevate(quartic));
+          }();
+          return std::function<void()>([&, quintic]() {
+               m_buffers.bv1 = make_traced_buffer(quintic->getControlPoints());
+               m_buffers.bi1 = make_traced_buffer(std::get<1>(quintic->getPatches()));
+               m_buffers.nQuinticPatches = hpuint(size(std::get<1>(quintic->getPatches())) / 21);
+               m_buffers.rc1 = std::make_unique<RenderContext>(make_render_context(m_renderer.getVertexArray(), *m_buffers.bi1, PatchType::QUINTIC));
+          });
+     });
+}
+
+void MeshPanels::unhighlight(Highlight& entries) {
+     auto& b = m_buffers;
+     for(auto i = entries.rbegin(); i != entries.rend(); ++i) {
+          ((std::get<0>(*i) == b.bc3->getId()) ? b.cc3 : b.ce3)[std::get<1>(*i)] = std::get<2>(*i);
+          glBindBuffer(GL_ARRAY_BUFFER, std::get<0>(*i));
+          glBufferSubData(GL_ARRAY_BUFFER, std::get<1>(*i) * sizeof(hpcolor), sizeof(hpcolor), &std::get<2>(*i));
+     }
+     glBindBuffer(GL_ARRAY_BUFFER, 0);
+     entries.clear();
+}
+
+bool MeshPanels::upload() {
+     auto uploaded = false;
+     for(auto i = std::begin(m_jobs); i != std::end(m_jobs); ) {
+          if(is_ready(*i)) {
+               i->get()();
+               i = m_jobs.erase(i);
+               uploaded = true;
+          } else ++i;
+     }
+     if(m_buffers.streamer && m_buffers.streamer->upload()) uploaded = true;
+     return uploaded;
+}
+
+void MeshPanels::wait() {
+     for(auto& job : m_jobs) job.wait();
+     upload();
+}
+
+}//namespace happah
+
@@ -0,0 +1,133 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleGraph.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <happah/graphics.hpp>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include "Bvh.hpp"
+#include "Culling.hpp"
+#include "Options.hpp"
+#include "PanelRenderer.hpp"
+#include "Profiler.hpp"
+#include "RenderQueue.hpp"
+#include "ThreadPool.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+class MeshPanels;
+
+//DEFINITIONS
+
+//NOTE: The panels of the mesh in the first path of the options.  The derived surfaces are built on a pool when a panel that needs them is first shown.  A task returns a function that uploads its result; upload calls it as soon as the task is done.  A finished task calls notify, which may wake up a loop that waits for events.
+class MeshPanels {
+public:
+     MeshPanels(const Options& options, PanelRenderer& renderer, std::function<void()> notify = std::function<void()>());
+
+     MeshPanels(const MeshPanels& panels) = delete;
+
+     ~MeshPanels();
+
+     MeshPanels& operator=(const MeshPanels& panels) = delete;
+
+     const PanelBuffers& getBuffers() const { return m_buffers; }
+
+     PanelCuller& getCuller() { return m_culler; }
+
+     const TriangleMesh<VertexP3>& getMesh() const { return m_mesh; }
+
+     hpuint getMeshLevel() const { return m_meshLevel; }//in the last frame
+
+     const std::string& getPickStatus() const { return m_pickStatus; }//what the cursor is over
+
+     hpuint getPointLevel() const { return m_pointLevel; }
+
+     const PrimitiveCounter& getPrimitives() const { return m_primitives; }
+
+     const RenderQueue& getQueue() const { return m_queue; }
+
+     hpuint getWireframeLevel() const { return m_wireframeLevel; }
+
+     bool isPicking() const { return bool(m_bvh); }
+
+     //NOTE: Requests the bounding volume hierarchy, which is built in the background; picking starts as soon as it is uploaded.  It is requested again when the topology of the mesh changes.
+     void enablePicking();
+
+     //NOTE: Highlights what the ray through the cursor hits in any shown panel that draws the mesh itself, and selects it if clicked.  Returns true if a highlight changed.
+     bool pick(const Viewport& viewport, const Point2D& cursor, const Panels& panels, bool clicked);
+
+     //NOTE: Reads the mesh file again.  Returns false if it cannot be read, in which case the previous mesh is kept.
+     bool reload();
+
+     //NOTE: Draws the shown panels that are not culled.
+     void render(Profiler& profiler, const Viewport& viewport, const Panels& shown);
+
+     //NOTE: Makes the programs and buffers and starts the tasks that the given panels need.  Nothing is made twice.
+     void require(const Panels& panels);
+
+     //NOTE: Uploads the results of the finished tasks and the meshlets that have been read.  Returns true if anything has been uploaded.
+     bool upload();
+
+     //NOTE: Waits for all tasks and uploads their results.
+     void wait();
+
+private:
+     using Highlight = std::vector<std::tuple<GLuint, hpuint, hpcolor> >;//buffer, corner and overwritten color
+
+     std::tuple<Point3D, Point3D> m_box;
+     PanelBuffers m_buffers;
+     std::unique_ptr<Bvh> m_bvh;
+     PanelCuller m_culler;
+     std::shared_future<TriangleGraph<VertexP3> > m_graph;
+     Highlight m_hovered;
+     std::tuple<int, hpuint, hpuint> m_hoveredPick;//type, triangle, corner
+     std::vector<std::future<std::function<void()> > > m_jobs;
+     TriangleMesh<VertexP3> m_mesh;
+     hpuint m_meshLevel = 0;
+     std::function<void()> m_notify;
+     const Options& m_options;
+     Palette m_palette;
+     bool m_picking = false;
+     std::string m_pickStatus;
+     hpuint m_pointLevel = 0;
+     ThreadPool m_pool;//NOTE: Declared after everything that the tasks use so that it is destroyed, and its tasks are finished, first.
+     PrimitiveCounter m_primitives;
+     RenderQueue m_queue;
+     PanelRenderer& m_renderer;
+     std::unordered_set<std::string> m_requested;
+     std::size_t m_savedBytes = 0;
+     Highlight m_selected;
+     hpuint m_wireframeLevel = 0;
+
+     Vector3D getOffset(Panel panel) const;
+
+     void highlight(Highlight& entries, const Pick& pick, const hpcolor& color);
+
+     template<class Task>
+     void request(const std::string& name, Task task);
+
+     //NOTE: The graph is only made for a task that has not been requested yet; the task receives it once it is done.
+     template<class Task>
+     void requestWithGraph(const std::string& name, Task task);
+
+     void unhighlight(Highlight& entries);
+
+};//MeshPanels
+
+}//namespace happah
+
@@ -0,0 +1,364 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <glm/gtc/matrix_access.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "GlslProgram.hpp"
+#include "Meshlets.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+//NOTE: A meshlet file consists of this header, the data of the meshlets and the table of meshlet records.
+struct MeshletHeader {
+     char magic[8];
+     std::uint32_t version;
+     std::uint32_t nMeshlets;
+     std::uint64_t sourceSize;
+     std::int64_t sourceTime;//nanoseconds
+     std::uint64_t tableOffset;
+
+};//MeshletHeader
+
+static constexpr char MESHLET_MAGIC[8] = { 'H', 'A', 'P', 'P', 'A', 'H', 'M', 'L' };
+static constexpr std::uint32_t MESHLET_VERSION = 1;
+static constexpr hpuint NO_SLOT = std::numeric_limits<hpuint>::max();
+static constexpr std::size_t MAX_LOADS = 64;//meshlets read at the same time
+static constexpr std::size_t SLOT_INDICES_SIZE = 3 * Meshlet::MAX_TRIANGLES * sizeof(std::uint32_t);
+static constexpr std::size_t SLOT_VERTICES_SIZE = 3 * Meshlet::MAX_VERTICES * sizeof(float);
+
+static const char* const MESHLET_VERTEX_SHADER = R"(
+#version 430 core
+
+layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+
+layout(location = 0) in vec3 position;
+
+uniform mat4 modelViewMatrix;
+
+out vec3 vPosition;
+
+void main() {
+     vec4 p = modelViewMatrix * vec4(position, 1.0);
+     vPosition = p.xyz;
+     gl_Position = projectionMatrix * p;
+}
+)";
+
+static std::int64_t get_time(const struct stat& status) { return std::int64_t(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec; }
+
+static void read_at(int file, void* data, std::size_t size, std::uint64_t offset) {
+     auto bytes = static_cast<char*>(data);
+     while(size > 0) {
+          auto n = pread(file, bytes, size, off_t(offset));
+          if(n <= 0) throw std::runtime_error("Failed to read meshlet file.");
+          bytes += n;
+          size -= std::size_t(n);
+          offset += std::uint64_t(n);
+     }
+}
+
+//NOTE: Spreads the lower 21 bits of x such that there are two zero bits between any two of them.
+static std::uint64_t spread(std::uint64_t x) {
+     x &= 0x1fffff;
+     x = (x | (x << 32)) & 0x1f00000000ffffull;
+     x = (x | (x << 16)) & 0x1f0000ff0000ffull;
+     x = (x | (x << 8)) & 0x100f00f00f00f00full;
+     x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+     x = (x | (x << 2)) & 0x1249249249249249ull;
+     return x;
+}
+
+std::string make_meshlet_file(const std::string& path, const TriangleMesh<VertexP3>& mesh, bool cache) {
+     struct stat source;
+     if(stat(path.c_str(), &source) < 0) throw std::runtime_error("Failed to open " + path + '.');
+     auto target = path + ".meshlets";
+     TraceZone zone("meshlet file");
+
+     if(cache) {
+          auto file = std::ifstream(target, std::ios::binary);
+          auto header = MeshletHeader();
+          if(file.read((char*)&header, sizeof(header)) && std::memcmp(header.magic, MESHLET_MAGIC, sizeof(MESHLET_MAGIC)) == 0 && header.version == MESHLET_VERSION && header.sourceSize == std::uint64_t(source.st_size) && header.sourceTime == get_time(source)) {
+               std::cout << "INFO: Read meshlet file " << target << '.' << std::endl;
+               return target;
+          }
+     }
+
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     auto nTriangles = hpuint(indices.size() / 3);
+
+     //NOTE: Sorting the triangles along the Morton curve of their centroids makes consecutive triangles spatially close.
+     auto lower = Point3D(std::numeric_limits<hpreal>::max());
+     auto upper = Point3D(-std::numeric_limits<hpreal>::max());
+     for(auto& vertex : vertices) {
+          lower = glm::min(lower, vertex.position);
+          upper = glm::max(upper, vertex.position);
+     }
+     auto scale = hpreal(0x1fffff) / glm::max(upper - lower, Vector3D(std::numeric_limits<hpreal>::min()));
+     auto order = std::vector<std::pair<std::uint64_t, hpuint> >(nTriangles);
+     for(auto t = hpuint(0); t < nTriangles; ++t) {
+          auto centroid = (vertices[indices[3 * t]].position + vertices[indices[3 * t + 1]].position + vertices[indices[3 * t + 2]].position) / hpreal(3);
+          auto cell = (centroid - lower) * scale;
+          order[t] = std::make_pair(spread(std::uint64_t(cell.x)) | (spread(std::uint64_t(cell.y)) << 1) | (spread(std::uint64_t(cell.z)) << 2), t);
+     }
+     std::sort(std::begin(order), std::end(order));
+
+     auto header = MeshletHeader();
+     std::memcpy(header.magic, MESHLET_MAGIC, sizeof(MESHLET_MAGIC));
+     header.version = MESHLET_VERSION;
+     header.sourceSize = std::uint64_t(source.st_size);
+     header.sourceTime = get_time(source);
+
+     auto temporary = target + ".tmp";
+     std::ofstream stream(temporary, std::ios::binary);
+     stream.write((const char*)&header, sizeof(header));
+
+     auto meshlets = std::vector<Meshlet>();
+     auto offset = std::uint64_t(sizeof(header));
+     auto owners = std::vector<hpuint>(vertices.size(), NO_SLOT);//meshlet that last used a vertex
+     auto locals = std::vector<std::uint32_t>(vertices.size());
+     auto positions = std::vector<float>();
+     auto triangles = std::vector<std::uint32_t>();
+
+     auto flush = [&]() {
+          auto meshlet = Meshlet();
+          auto nVertices = positions.size() / 3;
+          auto min = glm::vec3(std::numeric_limits<float>::max());
+          auto max = glm::vec3(-std::numeric_limits<float>::max());
+          for(auto i = std::size_t(0); i < nVertices; ++i) {
+               min = glm::min(min, glm::vec3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]));
+               max = glm::max(max, glm::vec3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]));
+          }
+          auto center = 0.5f * (min + max);
+          meshlet.radius = 0.0f;
+          for(auto i = std::size_t(0); i < nVertices; ++i) meshlet.radius = std::max(meshlet.radius, glm::length(glm::vec3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]) - center));
+          std::memcpy(meshlet.center, &center[0], sizeof(meshlet.center));
+          meshlet.offset = offset;
+          meshlet.nVertices = std::uint32_t(nVertices);
+          meshlet.nTriangles = std::uint32_t(triangles.size() / 3);
+          stream.write((const char*)positions.data(), positions.size() * sizeof(float));
+          stream.write((const char*)triangles.data(), triangles.size() * sizeof(std::uint32_t));
+          offset += positions.size() * sizeof(float) + triangles.size() * sizeof(std::uint32_t);
+          meshlets.push_back(meshlet);
+          positions.clear();
+          triangles.clear();
+     };
+
+     for(auto& entry : order) {
+          auto t = entry.second;
+          auto m = hpuint(meshlets.size());
+          auto nNew = hpuint(0);
+          for(auto i = 0; i < 3; ++i) if(owners[indices[3 * t + i]] != m) ++nNew;
+          if(triangles.size() == 3 * Meshlet::MAX_TRIANGLES || positions.size() / 3 + nNew > Meshlet::MAX_VERTICES) {
+               flush();
+               m = hpuint(meshlets.size());
+          }
+          for(auto i = 0; i < 3; ++i) {
+               auto v = indices[3 * t + i];
+               if(owners[v] != m) {
+                    owners[v] = m;
+                    locals[v] = std::uint32_t(positions.size() / 3);
+                    auto& position = vertices[v].position;
+                    positions.insert(std::end(positions), { float(position.x), float(position.y), float(position.z) });
+               }
+               triangles.push_back(locals[v]);
+          }
+     }
+     if(!triangles.empty()) flush();
+
+     header.nMeshlets = std::uint32_t(meshlets.size());
+     header.tableOffset = offset;
+     stream.write((const char*)meshlets.data(), meshlets.size() * sizeof(Meshlet));
+     stream.seekp(0);
+     stream.write((const char*)&header, sizeof(header));
+     stream.close();
+     if(!stream || std::rename(temporary.c_str(), target.c_str()) != 0) {
+          std::remove(temporary.c_str());
+          throw std::runtime_error("Failed to write meshlet file " + target + '.');
+     }
+     std::cout << "INFO: Wrote " << meshlets.size() << " meshlets to " << target << '.' << std::endl;
+     return target;
+}
+
+MeshletStreamer::MeshletStreamer(const std::string& path, std::size_t budget, std::function<void()> notify)
+     : m_file(open(path.c_str(), O_RDONLY)) {
+     if(m_file < 0) throw std::runtime_error("Failed to open " + path + '.');
+     auto header = MeshletHeader();
+     try {
+          read_at(m_file, &header, sizeof(header), 0);
+          if(std::memcmp(header.magic, MESHLET_MAGIC, sizeof(MESHLET_MAGIC)) != 0 || header.version != MESHLET_VERSION) throw std::runtime_error(path + " is not a meshlet file of this version.");
+          m_meshlets.resize(header.nMeshlets);
+          read_at(m_file, m_meshlets.data(), m_meshlets.size() * sizeof(Meshlet), header.tableOffset);
+     } catch(...) {
+          close(m_file);
+          throw;
+     }
+
+     m_nSlots = hpuint(std::max(std::size_t(1), std::min(m_meshlets.size(), budget / (SLOT_VERTICES_SIZE + SLOT_INDICES_SIZE))));
+     m_lastDrawn.assign(m_meshlets.size(), 0);
+     m_pending.assign(m_meshlets.size(), false);
+     m_slots.assign(m_meshlets.size(), NO_SLOT);
+     m_owners.assign(m_nSlots, NO_SLOT);
+     m_lruPositions.resize(m_nSlots);
+     for(auto slot = m_nSlots; slot > 0; --slot) m_unused.push_back(slot - 1);
+
+     try {
+          m_program = make_glsl_program("meshlet", { { GL_VERTEX_SHADER, MESHLET_VERTEX_SHADER }, { GL_FRAGMENT_SHADER, FLAT_FRAGMENT_SHADER } });
+     } catch(...) {
+          close(m_file);
+          throw;
+     }
+
+     glCreateBuffers(1, &m_vertices);
+     glCreateBuffers(1, &m_indices);
+     glNamedBufferStorage(m_vertices, m_nSlots * SLOT_VERTICES_SIZE, nullptr, GL_DYNAMIC_STORAGE_BIT);
+     glNamedBufferStorage(m_indices, m_nSlots * SLOT_INDICES_SIZE, nullptr, GL_DYNAMIC_STORAGE_BIT);
+     glCreateVertexArrays(1, &m_vertexArray);
+     glVertexArrayVertexBuffer(m_vertexArray, 0, m_vertices, 0, 3 * sizeof(float));
+     glVertexArrayAttribFormat(m_vertexArray, 0, 3, GL_FLOAT, GL_FALSE, 0);
+     glVertexArrayAttribBinding(m_vertexArray, 0, 0);
+     glEnableVertexArrayAttrib(m_vertexArray, 0);
+     glVertexArrayElementBuffer(m_vertexArray, m_indices);
+
+     m_pool = std::make_unique<ThreadPool>(4, std::move(notify));//NOTE: Reading is bound by the disk, not by the processor.
+
+     std::cout << "INFO: Streaming " << m_meshlets.size() << " meshlets through " << m_nSlots << " slots of " << (SLOT_VERTICES_SIZE + SLOT_INDICES_SIZE) << " bytes." << std::endl;
+}
+
+MeshletStreamer::~MeshletStreamer() {
+     m_pool.reset();
+     glDeleteVertexArrays(1, &m_vertexArray);
+     glDeleteBuffers(1, &m_indices);
+     glDeleteBuffers(1, &m_vertices);
+     glDeleteProgram(m_program);
+     close(m_file);
+}
+
+void MeshletStreamer::render(const glm::mat4& modelViewMatrix, const glm::mat4& projectionMatrix, const hpcolor& modelColor) {
+     ++m_frame;
+
+     //NOTE: The planes of the view frustum in model coordinates; a point p is inside if dot(plane, p) >= 0 for all planes.
+     auto matrix = projectionMatrix * modelViewMatrix;
+     glm::vec4 planes[6];
+     for(auto i = 0; i < 3; ++i) {
+          planes[2 * i] = glm::row(matrix, 3) + glm::row(matrix, i);
+          planes[2 * i + 1] = glm::row(matrix, 3) - glm::row(matrix, i);
+     }
+     for(auto& plane : planes) plane /= glm::length(glm::vec3(plane));
+     auto eye = glm::vec3(glm::inverse(modelViewMatrix)[3]);
+
+     auto counts = std::vector<GLsizei>();
+     auto offsets = std::vector<const void*>();
+     auto bases = std::vector<GLint>();
+     auto missing = std::vector<std::pair<float, hpuint> >();
+     m_nVisible = 0;
+     for(auto i = hpuint(0); i < m_meshlets.size(); ++i) {
+          auto& meshlet = m_meshlets[i];
+          auto center = glm::vec3(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+          auto visible = std::all_of(std::begin(planes), std::end(planes), [&](const glm::vec4& plane) { return glm::dot(glm::vec3(plane), center) + plane.w >= -meshlet.radius; });
+          if(!visible) continue;
+          ++m_nVisible;
+          auto slot = m_slots[i];
+          if(slot == NO_SLOT) {
+               if(!m_pending[i]) missing.emplace_back(glm::length(center - eye) - meshlet.radius, i);
+               continue;
+          }
+          m_lastDrawn[i] = m_frame;
+          m_lru.splice(std::end(m_lru), m_lru, m_lruPositions[slot]);
+          counts.push_back(GLsizei(3 * meshlet.nTriangles));
+          offsets.push_back((const void*)(slot * SLOT_INDICES_SIZE));
+          bases.push_back(GLint(slot * Meshlet::MAX_VERTICES));
+     }
+
+     //NOTE: Only as many meshlets are read as can be given a slot, which are the free slots and the slots of the meshlets that were not drawn in this frame less the loads that are under way.  Otherwise the data of visible meshlets that do not fit into the budget would be read every frame.
+     auto nSlots = m_unused.size();
+     for(auto slot : m_lru) {
+          if(m_lastDrawn[m_owners[slot]] == m_frame) break;
+          ++nSlots;
+     }
+     std::sort(std::begin(missing), std::end(missing));
+     for(auto& entry : missing) {
+          if(m_loads.size() == MAX_LOADS || m_loads.size() >= nSlots) break;
+          auto& meshlet = m_meshlets[entry.second];
+          m_pending[entry.second] = true;
+          auto size = std::size_t(meshlet.nVertices) * 3 * sizeof(float) + std::size_t(meshlet.nTriangles) * 3 * sizeof(std::uint32_t);
+          auto offset = meshlet.offset;
+          auto file = m_file;
+          m_loads.push_back({ entry.second, m_pool->submit([file, size, offset]() {
+               TraceZone zone("read meshlet");
+               auto data = std::vector<char>(size);
+               read_at(file, data.data(), size, offset);
+               return data;
+          }) });
+     }
+
+     m_nDrawn = hpuint(counts.size());
+     if(counts.empty()) return;
+     glUseProgram(m_program);
+     glUniformMatrix4fv(glGetUniformLocation(m_program, "modelViewMatrix"), 1, GL_FALSE, glm::value_ptr(modelViewMatrix));
+     glUniform4fv(glGetUniformLocation(m_program, "modelColor"), 1, glm::value_ptr(glm::vec4(modelColor)));
+     glBindVertexArray(m_vertexArray);
+     glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), GLsizei(counts.size()), bases.data());
+     glBindVertexArray(0);
+}
+
+bool MeshletStreamer::upload() {
+     auto uploaded = false;
+     for(auto load = std::begin(m_loads); load != std::end(m_loads); ) {
+          if(load->data.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+               ++load;
+               continue;
+          }
+
+          //NOTE: A slot is only reused if its meshlet was not drawn in the last frame; otherwise the data wait in the load until a slot can be reused.
+          auto slot = NO_SLOT;
+          if(!m_unused.empty()) slot = m_unused.back();
+          else if(!m_lru.empty() && m_lastDrawn[m_owners[m_lru.front()]] < m_frame) slot = m_lru.front();
+          if(slot == NO_SLOT) break;
+
+          auto i = load->meshlet;
+          auto data = std::vector<char>();
+          try {
+               data = load->data.get();
+          } catch(std::exception& e) {
+               std::cerr << "WARNING: " << e.what() << std::endl;
+          }
+          load = m_loads.erase(load);
+          m_pending[i] = false;
+          if(data.empty()) continue;
+          if(!m_unused.empty()) m_unused.pop_back();
+          else {
+               m_lru.pop_front();
+               m_slots[m_owners[slot]] = NO_SLOT;
+          }
+
+          TraceZone zone("upload meshlet");
+          zone.addBytes(data.size());
+          auto& meshlet = m_meshlets[i];
+          auto verticesSize = std::size_t(meshlet.nVertices) * 3 * sizeof(float);
+          glNamedBufferSubData(m_vertices, slot * SLOT_VERTICES_SIZE, verticesSize, data.data());
+          glNamedBufferSubData(m_indices, slot * SLOT_INDICES_SIZE, data.size() - verticesSize, data.data() + verticesSize);
+          m_slots[i] = slot;
+          m_owners[slot] = i;
+          m_lruPositions[slot] = m_lru.insert(std::end(m_lru), slot);
+          uploaded = true;
+     }
+     return uploaded;
+}
+
+}//namespace happah
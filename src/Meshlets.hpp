@@ -0,0 +1,109 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <happah/graphics/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+struct Meshlet;
+
+class MeshletStreamer;
+
+//NOTE: Partitions the mesh read from path into meshlets of spatially close triangles and writes them to a sidecar file (path + ".meshlets"), which is returned.  If cache is true, a file that was written for a mesh file of the same size and modification time is reused.
+std::string make_meshlet_file(const std::string& path, const TriangleMesh<VertexP3>& mesh, bool cache = true);
+
+//DEFINITIONS
+
+//NOTE: The record of a meshlet in a meshlet file.  Its data are the positions of its vertices as three floats each followed by three local indices per triangle.
+struct Meshlet {
+     static constexpr hpuint MAX_TRIANGLES = 1024;
+     static constexpr hpuint MAX_VERTICES = 1024;
+
+     float center[3];//of the bounding sphere
+     float radius;
+     std::uint64_t offset;//of the data in the file
+     std::uint32_t nVertices;
+     std::uint32_t nTriangles;
+
+};//Meshlet
+
+//NOTE: Draws a mesh that does not fit into GPU memory from a meshlet file.  The GPU holds as many meshlets as fit into the budget in slots of fixed size.  Every frame, the meshlets whose bounding spheres intersect the view frustum are drawn if they are resident and are otherwise read from the file on a pool, nearest first; a loaded meshlet replaces the least recently drawn one if no slot is free.  No more meshlets are read than can be given a slot, and a meshlet that has been read waits until a slot can be reused.
+class MeshletStreamer {
+public:
+     //NOTE: notify is called on a worker thread when a meshlet has been read.
+     MeshletStreamer(const std::string& path, std::size_t budget, std::function<void()> notify = std::function<void()>());
+
+     MeshletStreamer(const MeshletStreamer& streamer) = delete;
+
+     ~MeshletStreamer();
+
+     MeshletStreamer& operator=(const MeshletStreamer& streamer) = delete;
+
+     hpuint getNumberOfDrawn() const { return m_nDrawn; }//in the last frame
+
+     hpuint getNumberOfMeshlets() const { return hpuint(m_meshlets.size()); }
+
+     hpuint getNumberOfPending() const { return hpuint(m_loads.size()); }
+
+     hpuint getNumberOfResident() const { return hpuint(m_lru.size()); }
+
+     hpuint getNumberOfSlots() const { return m_nSlots; }
+
+     hpuint getNumberOfVisible() const { return m_nVisible; }//in the last frame
+
+     //NOTE: The projection matrix and the light are read from the frame uniform block (see FrameUniforms); the projection matrix is also needed here for culling.
+     void render(const glm::mat4& modelViewMatrix, const glm::mat4& projectionMatrix, const hpcolor& modelColor);
+
+     //NOTE: Copies the meshlets that have been read into slots; returns true if any meshlet was uploaded.
+     bool upload();
+
+private:
+     struct Load {
+          hpuint meshlet;
+          std::future<std::vector<char> > data;
+
+     };//Load
+
+     std::uint64_t m_frame = 0;
+     int m_file;
+     GLuint m_indices;
+     std::vector<std::uint64_t> m_lastDrawn;//frame per meshlet
+     std::vector<Load> m_loads;
+     std::list<hpuint> m_lru;//resident slots, least recently drawn first
+     std::vector<std::list<hpuint>::iterator> m_lruPositions;//per slot
+     std::vector<Meshlet> m_meshlets;
+     hpuint m_nDrawn = 0;
+     hpuint m_nSlots;
+     hpuint m_nVisible = 0;
+     std::vector<hpuint> m_owners;//meshlet per slot
+     std::vector<bool> m_pending;//per meshlet
+     GLuint m_program;
+     std::vector<hpuint> m_slots;//slot per meshlet
+     std::vector<hpuint> m_unused;//free slots
+     GLuint m_vertexArray;
+     GLuint m_vertices;
+     std::unique_ptr<ThreadPool> m_pool;//NOTE: Destroyed first so that no task outlives the file.
+
+};//MeshletStreamer
+
+}//namespace happah
+
@@ -0,0 +1,58 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <EGL/eglext.h>
+#include <stdexcept>
+
+#include "OffscreenContext.hpp"
+
+namespace happah {
+
+static EGLDisplay make_display() {
+     auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+     if(getPlatformDisplay) {
+          auto display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+          if(display != EGL_NO_DISPLAY) return display;
+     }
+     return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+OffscreenContext::OffscreenContext(hpuint width, hpuint height)
+     : m_display(make_display()), m_viewport(width, height) {
+     static const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_SURFACE_TYPE, 0, EGL_NONE };
+     static const EGLint contextAttributes[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 5, EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+
+     if(m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, nullptr, nullptr)) throw std::runtime_error("Failed to initialize EGL.");
+     if(!eglBindAPI(EGL_OPENGL_API)) throw std::runtime_error("Failed to bind OpenGL API.");
+     auto config = EGLConfig();
+     auto nConfigs = EGLint(0);
+     if(!eglChooseConfig(m_display, configAttributes, &config, 1, &nConfigs) || nConfigs == 0) throw std::runtime_error("Failed to find EGL configuration.");
+     m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttributes);
+     if(m_context == EGL_NO_CONTEXT) throw std::runtime_error("Failed to create offscreen context.");
+     if(!eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_context)) throw std::runtime_error("Failed to activate offscreen context.");
+     if(!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) throw std::runtime_error("Failed to initialize Glad.");
+     if(!GLAD_GL_VERSION_4_5) throw std::runtime_error("The offscreen context does not support OpenGL 4.5.");//NOTE: The buffers, vertex arrays and framebuffers are made with direct state access.
+
+     glCreateRenderbuffers(2, m_renderbuffers);
+     glNamedRenderbufferStorage(m_renderbuffers[0], GL_RGBA8, width, height);
+     glNamedRenderbufferStorage(m_renderbuffers[1], GL_DEPTH_COMPONENT24, width, height);
+     glCreateFramebuffers(1, &m_framebuffer);
+     glNamedFramebufferRenderbuffer(m_framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[0]);
+     glNamedFramebufferRenderbuffer(m_framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffers[1]);
+     if(glCheckNamedFramebufferStatus(m_framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) throw std::runtime_error("Failed to create offscreen framebuffer.");
+     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+     glViewport(0, 0, width, height);
+}
+
+OffscreenContext::~OffscreenContext() {
+     glDeleteFramebuffers(1, &m_framebuffer);
+     glDeleteRenderbuffers(2, m_renderbuffers);
+     eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+     eglDestroyContext(m_display, m_context);
+     eglTerminate(m_display);
+}
+
+}//namespace happah
+
@@ -0,0 +1,40 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics/glad.h>
+#include <happah/graphics/Viewport.hpp>
+#include <EGL/egl.h>
+
+namespace happah {
+
+//NOTE: Renders into a framebuffer object of a surfaceless EGL context so that no display or GPU is required (Mesa falls back to llvmpipe).
+class OffscreenContext {
+public:
+     OffscreenContext(hpuint width, hpuint height);
+
+     OffscreenContext(const OffscreenContext& context) = delete;
+
+     ~OffscreenContext();
+
+     OffscreenContext& operator=(const OffscreenContext& context) = delete;
+
+     GLuint getFramebuffer() const { return m_framebuffer; }
+
+     Viewport& getViewport() { return m_viewport; }
+
+private:
+     EGLContext m_context;
+     EGLDisplay m_display;
+     GLuint m_framebuffer;
+     GLuint m_renderbuffers[2];
+     Viewport m_viewport;
+
+};//OffscreenContext
+
+}//namespace happah
+
@@ -0,0 +1,120 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#include "Options.hpp"
+
+namespace happah {
+
+static hpuint parse_count(const std::string& option, const char* value) {
+     auto end = (char*)nullptr;
+     auto count = std::strtoul(value, &end, 10);
+     if(end == value || *end != '\0' || count == 0) throw std::runtime_error("Invalid value '" + std::string(value) + "' for " + option + '.');
+     return hpuint(count);
+}
+
+Camera make_camera(const std::string& name) {
+     static const char* const names[] = { "front", "back", "left", "right", "top", "bottom", "iso" };
+     for(auto i = hpuint(0); i < sizeof(names) / sizeof(names[0]); ++i) if(name == names[i]) return Camera(i);
+     throw std::runtime_error("Unknown camera '" + name + "'.");
+}
+
+Options make_options(int argc, char* argv[]) {
+     static const auto usage = std::string("Usage: happah [--benchmark frames] [--budget megabytes --show=mesh] [--camera preset] [--capture file.rgb|directory] [--compact] [--continuous] [--deviation distance] [--fast-replay] [--fps rate] [--list file] [--no-cache] [--record log] [--repeat count] [--replay log] [--segments count] [--show panel,...] [--size widthxheight] [--tessellate file] [--thumbnails directory] [--tolerance pixels] [--trace file] path-to-off-file...");
+
+     auto options = Options();
+     auto hasCamera = false;//NOTE: The defaults of --camera, --segments and --show cannot be told apart from given values.
+     auto hasSegments = false;
+     auto hasShow = false;
+
+     for(auto i = 1; i < argc; ++i) {
+          auto argument = std::string(argv[i]);
+          auto value = std::string();
+          auto hasValue = false;
+          auto equals = argument.find('=');
+          if(argument.compare(0, 2, "--") == 0 && equals != std::string::npos) {
+               value = argument.substr(equals + 1);
+               argument.erase(equals);
+               hasValue = true;
+          }
+          auto next = [&]() -> const char* {
+               if(hasValue) return value.c_str();
+               if(i + 1 == argc) throw std::runtime_error("Missing value for " + argument + ".\n" + usage);
+               return argv[++i];
+          };
+
+          if(argument == "--benchmark") options.benchmark = parse_count(argument, next());
+          else if(argument == "--budget") options.budget = parse_count(argument, next());
+          else if(argument == "--camera") {
+               options.camera = make_camera(next());
+               hasCamera = true;
+          }
+          else if(argument == "--capture") options.capture = next();
+          else if(argument == "--compact") options.compact = true;
+          else if(argument == "--continuous") options.continuous = true;
+          else if(argument == "--deviation") {
+               auto deviation = next();
+               auto end = (char*)nullptr;
+               options.deviation = hpreal(std::strtod(deviation, &end));
+               if(end == deviation || *end != '\0' || !(options.deviation > 0)) throw std::runtime_error("Invalid value '" + std::string(deviation) + "' for --deviation.");
+          } else if(argument == "--fast-replay") options.fastReplay = true;
+          else if(argument == "--fps") options.fps = parse_count(argument, next());
+          else if(argument == "--list") {
+               auto path = std::string(next());
+               auto stream = std::ifstream(path);
+               if(!stream) throw std::runtime_error("Failed to open " + path + '.');
+               for(auto line = std::string(); std::getline(stream, line); ) if(!line.empty()) options.paths.push_back(line);
+          } else if(argument == "--no-cache") options.cache = false;
+          else if(argument == "--record") options.record = next();
+          else if(argument == "--repeat") options.repetitions = parse_count(argument, next());
+          else if(argument == "--replay") options.replay = next();
+          else if(argument == "--segments") {
+               options.segments = parse_count(argument, next());
+               hasSegments = true;
+          } else if(argument == "--show") {
+               options.panels = make_panels(next());
+               hasShow = true;
+          } else if(argument == "--size") {
+               auto size = std::string(next());
+               auto x = size.find('x');
+               if(x == std::string::npos) throw std::runtime_error("Invalid value '" + size + "' for --size.");
+               options.width = parse_count(argument, size.substr(0, x).c_str());
+               options.height = parse_count(argument, size.substr(x + 1).c_str());
+          } else if(argument == "--tessellate") options.tessellation = next();
+          else if(argument == "--thumbnails") options.thumbnails = next();
+          else if(argument == "--tolerance") {
+               auto tolerance = next();
+               auto end = (char*)nullptr;
+               options.tolerance = hpreal(std::strtod(tolerance, &end));
+               if(end == tolerance || *end != '\0' || !(options.tolerance > 0)) throw std::runtime_error("Invalid value '" + std::string(tolerance) + "' for --tolerance.");
+          } else if(argument == "--trace") options.trace = next();
+          else if(argument.compare(0, 2, "--") == 0) throw std::runtime_error("Unknown option " + argument + ".\n" + usage);
+          else options.paths.push_back(argument);
+     }
+
+     if(options.paths.empty()) throw std::runtime_error(usage);
+     if(!options.record.empty() && !options.replay.empty()) throw std::runtime_error("A session cannot be recorded and replayed at once.");
+     if(options.fastReplay && options.replay.empty()) throw std::runtime_error("--fast-replay requires --replay.");
+     if(options.benchmark && (!options.record.empty() || !options.replay.empty())) throw std::runtime_error("--benchmark renders offscreen without input and cannot be combined with --record or --replay.");
+     if(options.budget > 0 && options.paths.size() > 1) throw std::runtime_error("--budget requires a single path.");
+     if(options.budget > 0) for(auto i = hpuint(0); i < Panels::SIZE; ++i) if(options.panels[Panel(i)] != (Panel(i) == Panel::MESH)) throw std::runtime_error("--budget only covers the mesh panel and requires --show=mesh.");
+     if(options.paths.size() > 1 && (!options.record.empty() || !options.replay.empty() || options.compact || options.tolerance > 0)) throw std::runtime_error("--record, --replay, --compact and --tolerance require a single path.");
+     if(options.paths.size() > 1 && options.thumbnails.empty() && hasShow) throw std::runtime_error("The scene of several paths has no panels; --show requires a single path or --thumbnails.");
+     if(options.fps && (options.paths.size() > 1 || options.benchmark || !options.thumbnails.empty() || !options.tessellation.empty())) throw std::runtime_error("--fps only limits the window of a single path.");
+     if(!options.tessellation.empty() && (options.paths.size() > 1 || options.benchmark || !options.thumbnails.empty() || options.budget > 0 || !options.record.empty() || !options.replay.empty())) throw std::runtime_error("--tessellate requires a single path and cannot be combined with --benchmark, --thumbnails, --budget, --record or --replay; pass --repeat to time the evaluator.");
+     if(options.repetitions && options.tessellation.empty()) throw std::runtime_error("--repeat requires --tessellate.");
+     if(!options.capture.empty() && (options.paths.size() > 1 || !options.tessellation.empty() || !options.thumbnails.empty())) throw std::runtime_error("--capture requires a single path and cannot be combined with --tessellate or --thumbnails.");
+     if(options.deviation > 0 && options.tessellation.empty()) throw std::runtime_error("--deviation requires --tessellate.");
+     if(hasSegments && options.tessellation.empty()) throw std::runtime_error("--segments requires --tessellate.");
+     if(hasCamera && options.thumbnails.empty()) throw std::runtime_error("--camera requires --thumbnails.");
+     if(!options.thumbnails.empty() && (options.benchmark || options.budget > 0 || !options.record.empty() || !options.replay.empty())) throw std::runtime_error("--thumbnails cannot be combined with --benchmark, --budget, --record or --replay.");
+     return options;
+}
+
+}//namespace happah
+
@@ -0,0 +1,56 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <string>
+#include <vector>
+
+#include "Panels.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+//NOTE: The direction from which a thumbnail shows the model after look_at has framed it.
+enum class Camera : hpuint { FRONT, BACK, LEFT, RIGHT, TOP, BOTTOM, ISO };
+
+struct Options;
+
+Camera make_camera(const std::string& name);//front, back, left, right, top, bottom or iso
+
+Options make_options(int argc, char* argv[]);
+
+//DEFINITIONS
+
+struct Options {
+     hpuint benchmark = 0;//number of frames to render offscreen; interactive if zero
+     std::size_t budget = 0;//megabytes of GPU memory for the meshlets of the mesh panel, which must be the only panel; the whole mesh is uploaded if zero
+     bool cache = true;//read and write the binary mesh cache next to the input file and the program binary cache
+     Camera camera = Camera::FRONT;//view of the thumbnails
+     std::string capture;//raw video file (.rgb) or directory of PNG files to which every drawn frame is written
+     bool compact = false;//draw the triangle colors, edges and patches panels from the indexed mesh with palette-indexed colors
+     bool continuous = false;//redraw every frame instead of only when the view changed
+     hpreal deviation = 0;//distance from the quintic spline surface within which its CPU tessellation stays; segments per edge of every patch if zero
+     bool fastReplay = false;//replay the input log one recorded frame per frame instead of at the recorded times
+     hpuint fps = 0;//maximum number of frames per second; unlimited if zero
+     hpuint height = 480;
+     Panels panels;//panels that are visible at startup
+     std::vector<std::string> paths;//OFF files; several files are shown side by side as one scene
+     std::string record;//input log to which the events of the session are written
+     hpuint repetitions = 0;//number of timed evaluations of the quintic spline surface with the scalar and the AVX2 evaluator before it is tessellated on the CPU
+     std::string replay;//input log whose events replace the input of the session
+     hpuint segments = 8;//per edge of every quintic patch in the CPU tessellation, or at most with a deviation
+     std::string tessellation;//OFF file to which the quintic spline surface is written after it has been tessellated on the CPU
+     std::string thumbnails;//directory to which every shown panel of every file is rendered offscreen as a PNG file
+     hpreal tolerance = 0;//edge length in pixels of tessellated spline triangles; fixed tessellation levels if zero
+     std::string trace;//Chrome trace file to which the zones of the session are written
+     hpuint width = 640;
+
+};//Options
+
+}//namespace happah
+
@@ -0,0 +1,438 @@
+// Copyright 2017
+//   Pawel Herman   - Karlsruhe Institute of Technology - pherman@ira.uka.de
+//   Hedwig Amberg  - Karlsruhe Institute of Technology - hedwigdorothea@gmail.com
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// 2017.07 - Hedwig Amberg    - Added new shader for coloring triangles individually.
+// 2017.08 - Hedwig Amberg    - Added new shader for coloring both triangles and edges.
+
+#include <happah/format.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#include "PanelRenderer.hpp"
+
+namespace happah {
+
+struct PanelShaders {
+     decltype(make_edge_fragment_shader()) ed_fr = make_edge_fragment_shader();
+     decltype(make_geometry_shader(std::string())) ed_gm = make_geometry_shader(p("shaders/edge.g.glsl"));
+     decltype(make_edge_vertex_shader()) ed_vx = make_edge_vertex_shader();
+     decltype(make_highlight_lines_fragment_shader()) hl_fr = make_highlight_lines_fragment_shader();
+     decltype(make_tessellation_evaluation_shader(std::string())) lb_te = make_tessellation_evaluation_shader(p("shaders/loop-box-spline.te.glsl"));
+     decltype(make_geometry_shader(std::string())) nm_gm = make_geometry_shader(p("shaders/normals.g.glsl"));
+     decltype(make_patches_vertex_shader()) pt_vx = make_patches_vertex_shader();
+     decltype(make_geometry_shader(std::string())) pt_gm = make_geometry_shader(p("shaders/patches.g.glsl"));
+     decltype(make_patches_fragment_shader()) pt_fr = make_patches_fragment_shader();
+     decltype(make_tessellation_control_shader(std::string())) qp_tc = make_tessellation_control_shader(p("glsl/adaptive-quintic-patch.tc.glsl"));
+     decltype(make_tessellation_evaluation_shader(std::string())) qp_te = make_tessellation_evaluation_shader(p("shaders/quintic-patch.te.glsl"));
+     decltype(make_sphere_impostor_fragment_shader()) si_fr = make_sphere_impostor_fragment_shader();
+     decltype(make_sphere_impostor_geometry_shader()) si_gm = make_sphere_impostor_geometry_shader();
+     decltype(make_simple_fragment_shader()) sm_fr = make_simple_fragment_shader();
+     decltype(make_simple_vertex_shader()) sm_vx = make_simple_vertex_shader();
+     decltype(make_triangles_fragment_shader()) tr_fr = make_triangles_fragment_shader();
+     decltype(make_geometry_shader(std::string())) tr_gm = make_geometry_shader(p("shaders/triangles.g.glsl"));
+     decltype(make_triangles_vertex_shader()) tr_vx = make_triangles_vertex_shader();
+     decltype(make_wireframe_fragment_shader()) wf_fr = make_wireframe_fragment_shader();
+     decltype(make_geometry_shader(std::string())) wf_gm = make_geometry_shader(p("shaders/wireframe.g.glsl"));
+
+};//PanelShaders
+
+//NOTE: Replaces the source of a shader by the contents of the file and recompiles it.  If the new source does not compile, the previous source is compiled again so that the shader stays usable, and false is returned.
+static bool reload_shader(GLuint shader, const std::string& path) {
+     auto stream = std::ifstream(path);
+     auto source = std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+     auto length = GLint(0);
+     glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &length);
+     auto previous = std::string(length, '\0');
+     if(length) glGetShaderSource(shader, length, nullptr, &previous[0]);
+     previous.resize(std::strlen(previous.c_str()));
+     auto compile = [&](const std::string& text) {
+          auto data = text.c_str();
+          glShaderSource(shader, 1, &data, nullptr);
+          glCompileShader(shader);
+          auto status = GLint(GL_FALSE);
+          glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+          return status == GL_TRUE;
+     };
+     if(compile(source)) return true;
+     auto log = std::string(1024, '\0');
+     glGetShaderInfoLog(shader, GLsizei(log.size()), nullptr, &log[0]);
+     std::cerr << "WARNING: Failed to compile " << path << ": " << log.c_str() << std::endl;
+     compile(previous);
+     return false;
+}
+
+//NOTE: Replaces the named string of a header by the contents of the file and recompiles the shaders that may include it.  If any of them does not compile, it is reported, the previous header is restored and the shaders are compiled again so that they stay usable, and false is returned.
+static bool reload_header(const std::string& name, const std::string& path, std::initializer_list<GLuint> shaders) {
+     auto length = GLint(0);
+     glGetNamedStringivARB(GLint(name.size()), name.c_str(), GL_NAMED_STRING_LENGTH_ARB, &length);
+     auto previous = std::string(length, '\0');
+     if(length) glGetNamedStringARB(GLint(name.size()), name.c_str(), length, &length, &previous[0]);
+     previous.resize(length);
+     load(name, path);
+     auto compile = [&](bool report) {
+          auto compiled = true;
+          for(auto shader : shaders) {
+               glCompileShader(shader);
+               auto status = GLint(GL_FALSE);
+               glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+               if(status == GL_TRUE) continue;
+               compiled = false;
+               if(!report) continue;
+               auto log = std::string(1024, '\0');
+               glGetShaderInfoLog(shader, GLsizei(log.size()), nullptr, &log[0]);
+               std::cerr << "WARNING: Failed to compile a shader with " << path << ": " << log.c_str() << std::endl;
+          }
+          return compiled;
+     };
+     if(compile(true)) return true;
+     glNamedStringARB(GL_SHADER_INCLUDE_ARB, GLint(name.size()), name.c_str(), GLint(previous.size()), previous.c_str());
+     compile(false);
+     return false;
+}
+
+Vector3D make_panel_offset(Panel panel, const Vector3D& lengths, const Vector3D& padding) {
+     auto x = lengths.x + padding.x;
+     auto y = lengths.y + padding.y;
+     switch(panel) {
+     case Panel::MESH: return Vector3D(-x, 0.0, 0.0);
+     case Panel::TRIANGLE_ARRAY: return Vector3D(-x, -y, 0.0);
+     case Panel::QUINTIC: return Vector3D(x, 0.0, 0.0);
+     case Panel::LOOP_BOX_SPLINE: return Vector3D(0.0, -y, 0.0);
+     case Panel::POINT_CLOUD: return Vector3D(x, -y, 0.0);
+     case Panel::WIREFRAME: return Vector3D(-x, y, 0.0);
+     case Panel::TRIANGLE_COLORS: return Vector3D(0.0, y, 0.0);
+     case Panel::EDGES: return Vector3D(0.0, 0.0, 0.0);
+     case Panel::PATCHES: return Vector3D(x, y, 0.0);
+     }
+     return Vector3D(0.0, 0.0, 0.0);
+}
+
+hpreal make_projected_size(const Point3D& lower, const Point3D& upper, const glm::mat4& projectionMatrix, const glm::mat4& modelViewMatrix, const Vector2D& viewportSize) {
+     auto minimum = Vector2D(std::numeric_limits<hpreal>::max());
+     auto maximum = Vector2D(-std::numeric_limits<hpreal>::max());
+     for(auto i = 0; i < 8; ++i) {
+          auto corner = Point4D((i & 1) ? upper.x : lower.x, (i & 2) ? upper.y : lower.y, (i & 4) ? upper.z : lower.z, 1.0);
+          auto point = projectionMatrix * modelViewMatrix * corner;
+          if(point.w <= 0) return std::numeric_limits<hpreal>::max();
+          minimum = glm::min(minimum, Vector2D(point) / point.w);
+          maximum = glm::max(maximum, Vector2D(point) / point.w);
+     }
+     return glm::length(hpreal(0.5) * (maximum - minimum) * viewportSize);
+}
+
+PanelRenderer::PanelRenderer(const Options& options)
+     : m_vertexArray(make_vertex_array()), m_budget(options.budget), m_compact(options.compact), m_headers({
+          std::make_tuple("/happah/illumination.h.glsl", p("shaders/illumination.h.glsl")),
+          std::make_tuple("/happah/paint.h.glsl", p("shaders/paint.h.glsl")),
+          std::make_tuple("/happah/geometry.h.glsl", p("shaders/geometry.h.glsl"))
+     }), m_programs(ProgramCache::make_directory(), options.cache), m_rc30(make_render_context(m_vertexArray, PatchType::TRIANGLE)), m_rc31(make_render_context(m_vertexArray, PatchType::TRIANGLE)), m_rc4(make_render_context(m_vertexArray, PatchType::POINT)), m_tolerance(options.tolerance) {
+     for(auto& header : m_headers) {
+          load(std::get<0>(header), std::get<1>(header));
+          m_programs.addInclude(std::get<1>(header));
+     }
+     m_shaders = std::make_unique<PanelShaders>();
+
+     auto& s = *m_shaders;
+     m_shaderFiles = std::vector<ShaderFile>({
+          { p("shaders/edge.g.glsl"), s.ed_gm.getId(), { &m_edp } },
+          { p("shaders/loop-box-spline.te.glsl"), s.lb_te.getId(), { &m_lmp } },
+          { p("shaders/normals.g.glsl"), s.nm_gm.getId(), { &m_tmp, &m_lmp } },
+          { p("shaders/patches.g.glsl"), s.pt_gm.getId(), { &m_ptc } },
+          { p("glsl/adaptive-quintic-patch.tc.glsl"), s.qp_tc.getId(), { &m_qpp } },
+          { p("shaders/quintic-patch.te.glsl"), s.qp_te.getId(), { &m_qpp } },
+          { p("shaders/triangles.g.glsl"), s.tr_gm.getId(), { &m_trp } },
+          { p("shaders/wireframe.g.glsl"), s.wf_gm.getId(), { &m_wfp } }
+     });
+
+     auto edgeColor = make_attribute(2, 4, DataType::FLOAT);
+     auto position = make_attribute(0, 4, DataType::FLOAT);
+     auto vertexColor = make_attribute(1, 4, DataType::FLOAT);
+
+     describe(m_vertexArray, 0, position);
+     describe(m_vertexArray, 1, vertexColor);
+     describe(m_vertexArray, 2, edgeColor);
+}
+
+PanelRenderer::~PanelRenderer() {}
+
+void PanelRenderer::drop(const std::vector<std::unique_ptr<Program>*>& programs) { for(auto program : programs) if(*program) m_stale[program] = std::move(*program); }
+
+std::vector<std::string> PanelRenderer::getShaderPaths() const {
+     auto paths = std::vector<std::string>();
+     for(auto& file : m_shaderFiles) paths.push_back(file.path);
+     for(auto& header : m_headers) paths.push_back(std::get<1>(header));
+     return paths;
+}
+
+template<class... Shaders>
+void PanelRenderer::make(std::unique_ptr<Program>& program, const std::string& label, Shaders&... shaders) {
+     if(program) return;
+     try {
+          program = std::make_unique<Program>(m_programs.make_program(label, shaders...));
+     } catch(std::exception& e) {
+          auto old = m_stale.find(&program);
+          if(old == std::end(m_stale)) throw;
+          std::cerr << "WARNING: Keeping the previous " << label << " program: " << e.what() << std::endl;
+          program = std::move(old->second);
+     }
+     m_stale.erase(&program);
+}
+
+//NOTE: The draw items are sorted by program and vertex buffers.  Uniforms that are the same for all items of a program are set when the program is activated, which happens once per frame; the items only set what differs between panels.  The items are drawn after this function has returned, so they capture what they need by value.
+void PanelRenderer::push(RenderQueue& queue, const PanelBuffers& buffers, const PanelFrame& frame, const Panels& panels) {
+     auto blue = hpcolor(0.0, 0.0, 1.0, 1.0);
+     auto green = hpcolor(0.0, 1.0, 0.0, 1.0);
+     auto red = hpcolor(1.0, 0.0, 0.0, 1.0);
+
+     auto bandWidth = 1.0;
+     auto beamDirection = Vector3D(0.0, 0.0, 1.0);
+     auto beamOrigin = Point3D(10.0, 0.0, 0.0);
+     auto edgeWidth = 0.006; //0.02;//TODO: 0.1 * average height?
+     auto level0 = std::array<float, 2>({ 50, 50 });
+     auto level1 = std::array<float, 4>({ 30, 30, 30, 30 });
+
+     auto s = m_shaders.get();
+     auto projectionMatrix = frame.projectionMatrix;
+     auto viewMatrix = frame.viewMatrix;
+     auto light = glm::normalize(Point3D(viewMatrix[0]));
+     auto tempDirection = viewMatrix * Vector4D(beamDirection, 0.0);
+     auto tempOrigin = viewMatrix * Point4D(beamOrigin, 1.0);
+     auto nTriangles = buffers.nTriangles;
+     auto primitives = frame.primitives;
+     auto tolerance = m_tolerance;
+     auto getModelViewMatrix = [&](Panel panel) { return glm::translate(viewMatrix, frame.offsets[hpuint(panel)]); };
+
+     auto& lods = buffers.lods;
+     auto meshBuffer = (frame.meshLevel) ? lods[frame.meshLevel - 1].vertices.get() : buffers.bv0.get();
+     auto meshContext = (frame.meshLevel) ? lods[frame.meshLevel - 1].context.get() : buffers.rc0.get();
+     auto wireframeBuffer = (frame.wireframeLevel) ? lods[frame.wireframeLevel - 1].vertices.get() : buffers.bv0.get();
+     auto wireframeContext = (frame.wireframeLevel) ? lods[frame.wireframeLevel - 1].context.get() : buffers.rc0.get();
+     auto pointBuffer = (frame.pointLevel) ? lods[frame.pointLevel - 1].points.get() : buffers.bv0.get();
+     auto nPoints = (frame.pointLevel) ? lods[frame.pointLevel - 1].nPoints : buffers.nPoints;
+     auto pointRadius = (frame.pointLevel) ? std::max(frame.radius, hpreal(0.5) * lods[frame.pointLevel - 1].spacing) : frame.radius;
+
+     auto setSimpleUniforms = [s, projectionMatrix, light]() {
+          s->sm_vx.setProjectionMatrix(projectionMatrix);
+          s->sm_fr.setLight(light);
+     };
+
+     if(panels[Panel::QUINTIC] && m_qpp && buffers.rc1) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::QUINTIC);
+          auto qpp = m_qpp.get();
+          auto rc1 = buffers.rc1.get();
+          queue.push({ "quintic", qpp, [=]() {
+               activate(*qpp, PatchType::QUINTIC);
+               s->sm_vx.setProjectionMatrix(projectionMatrix);
+               if(tolerance > 0) glProgramUniform1f(qpp->getId(), glGetUniformLocation(qpp->getId(), "tolerance"), tolerance);
+               s->hl_fr.setBandColor0(red);
+               s->hl_fr.setBandColor1(green);
+               s->hl_fr.setBandWidth(bandWidth);
+               s->hl_fr.setBeam(Point3D(tempOrigin) / tempOrigin.w, glm::normalize(Vector3D(tempDirection)));
+               s->hl_fr.setLight(light);
+          }, {{ buffers.bv1.get() }}, [=]() {
+               s->sm_vx.setModelViewMatrix(modelViewMatrix);
+               if(tolerance == 0) {
+                    TessellationControlShader::setInnerTessellationLevel(level0);
+                    TessellationControlShader::setOuterTessellationLevel(level1);
+               }
+               if(tolerance > 0 && primitives) primitives->begin();
+               render(*qpp, *rc1);
+               if(tolerance > 0 && primitives) primitives->end();
+          } });
+     }
+
+     if(panels[Panel::MESH] && buffers.streamer) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::MESH);
+          auto streamer = buffers.streamer.get();
+          queue.push({ "mesh", nullptr, nullptr, {{}}, [=]() { streamer->render(modelViewMatrix, projectionMatrix, blue); } });
+     }
+
+     if(panels[Panel::MESH] && m_budget == 0 && m_tmp && meshBuffer && meshContext) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::MESH);
+          auto tmp = m_tmp.get();
+          queue.push({ "mesh", tmp, [=]() {
+               activate(*tmp);
+               setSimpleUniforms();
+          }, {{ meshBuffer }}, [=]() {
+               s->sm_vx.setModelViewMatrix(modelViewMatrix);
+               s->sm_fr.setModelColor(blue);
+               render(*tmp, *meshContext);
+          } });
+     }
+
+     if(panels[Panel::TRIANGLE_ARRAY] && m_tmp && buffers.bv3) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::TRIANGLE_ARRAY);
+          auto tmp = m_tmp.get();
+          queue.push({ "triangle array", tmp, [=]() {
+               activate(*tmp);
+               setSimpleUniforms();
+          }, {{ buffers.bv3.get() }}, [=]() {
+               s->sm_vx.setModelViewMatrix(modelViewMatrix);
+               s->sm_fr.setModelColor(red);
+               render(*tmp, m_rc30, nTriangles);
+          } });
+     }
+
+     if(panels[Panel::LOOP_BOX_SPLINE] && m_lmp && buffers.rc2) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::LOOP_BOX_SPLINE);
+          auto lmp = m_lmp.get();
+          auto rc2 = buffers.rc2.get();
+          //NOTE: The box spline patches are tessellated uniformly, which is crack-free, at the level at which a patch of average size meets the tolerance.
+          auto inner = level0;
+          auto outer = level1;
+          if(tolerance > 0) {
+               auto size = make_projected_size(frame.lower, frame.upper, projectionMatrix, modelViewMatrix, frame.viewportSize);
+               auto level = float(glm::clamp(size / (std::sqrt(hpreal(buffers.nBoxPatches)) * tolerance), hpreal(1), hpreal(64)));
+               inner = std::array<float, 2>({ level, level });
+               outer = std::array<float, 4>({ level, level, level, level });
+          }
+          queue.push({ "loop box spline", lmp, [=]() {
+               activate(*lmp, PatchType::LOOP_BOX_SPLINE);
+               setSimpleUniforms();
+          }, {{ buffers.bv2.get() }}, [=]() {
+               TessellationControlShader::setInnerTessellationLevel(inner);
+               TessellationControlShader::setOuterTessellationLevel(outer);
+               s->sm_vx.setModelViewMatrix(modelViewMatrix);
+               s->sm_fr.setModelColor(blue);
+               render(*lmp, *rc2);
+          } });
+     }
+
+     if(panels[Panel::POINT_CLOUD] && m_pcp && pointBuffer) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::POINT_CLOUD);
+          auto pcp = m_pcp.get();
+          queue.push({ "point cloud", pcp, [=]() {
+               activate(*pcp);
+               s->sm_vx.setProjectionMatrix(projectionMatrix);
+               s->si_gm.setProjectionMatrix(projectionMatrix);
+               s->si_fr.setLight(light);
+               s->si_fr.setModelColor(blue);
+               s->si_fr.setProjectionMatrix(projectionMatrix);
+          }, {{ pointBuffer }}, [=]() {
+               s->sm_vx.setModelViewMatrix(modelViewMatrix);
+               s->si_gm.setRadius(pointRadius);
+               s->si_fr.setRadius(pointRadius);
+               render(*pcp, m_rc4, nPoints);
+          } });
+     }
+
+     if(panels[Panel::WIREFRAME] && m_wfp && wireframeBuffer && wireframeContext) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::WIREFRAME);
+          auto wfp = m_wfp.get();
+          queue.push({ "wireframe", wfp, [=]() {
+               activate(*wfp);
+               s->sm_vx.setProjectionMatrix(projectionMatrix);
+               s->wf_fr.setEdgeWidth(edgeWidth);
+               s->wf_fr.setEdgeColor(red);
+               s->wf_fr.setLight(light);
+               s->wf_fr.setModelColor(blue);
+          }, {{ wireframeBuffer }}, [=]() {
+               s->sm_vx.setModelViewMatrix(modelViewMatrix);
+               render(*wfp, *wireframeContext);
+          } });
+     }
+
+     if(panels[Panel::TRIANGLE_COLORS] && m_trp && buffers.bv3 && buffers.bt3) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::TRIANGLE_COLORS);
+          auto trp = m_trp.get();
+          queue.push({ "triangle colors", trp, [=]() {
+               activate(*trp);
+               s->tr_vx.setProjectionMatrix(projectionMatrix);
+               s->tr_fr.setLight(light);
+          }, {{ buffers.bv3.get(), buffers.bt3.get() }}, [=]() {
+               s->tr_vx.setModelViewMatrix(modelViewMatrix);
+               render(*trp, m_rc31, nTriangles);
+          } });
+     }
+
+     if(panels[Panel::EDGES] && m_edp && buffers.bv3 && buffers.be3) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::EDGES);
+          auto edp = m_edp.get();
+          queue.push({ "edges", edp, [=]() {
+               activate(*edp);
+               s->ed_vx.setProjectionMatrix(projectionMatrix);
+               s->ed_fr.setEdgeWidth(edgeWidth);
+               s->ed_fr.setLight(light);
+               s->ed_fr.setModelColor(blue);
+          }, {{ buffers.bv3.get(), buffers.bc3.get(), buffers.be3.get() }}, [=]() {
+               s->ed_vx.setModelViewMatrix(modelViewMatrix);
+               render(*edp, m_rc31, nTriangles);
+          } });
+     }
+
+     if(panels[Panel::PATCHES] && m_ptc && buffers.bv3 && buffers.bt3 && buffers.be3) {
+          auto modelViewMatrix = getModelViewMatrix(Panel::PATCHES);
+          auto ptc = m_ptc.get();
+          queue.push({ "patches", ptc, [=]() {
+               activate(*ptc);
+               s->pt_vx.setProjectionMatrix(projectionMatrix);
+               s->pt_fr.setEdgeWidth(edgeWidth);
+               s->pt_fr.setLight(light);
+          }, {{ buffers.bv3.get(), buffers.bt3.get(), buffers.be3.get(), buffers.bc3.get() }}, [=]() {//position, triangle color, edge color, vertex color
+               s->pt_vx.setModelViewMatrix(modelViewMatrix);
+               render(*ptc, m_rc31, nTriangles);
+          } });
+     }
+
+     if(buffers.compact && buffers.bv0) {
+          auto compact = buffers.compact.get();
+          auto vertices = buffers.bv0->getId();
+          auto indices = buffers.bi0->getId();
+          auto stride = hpuint(sizeof(VertexP3) / sizeof(hpreal));
+          auto pushCompact = [&](const std::string& pass, CompactColors::Mode mode, Panel panel) {
+               auto modelViewMatrix = getModelViewMatrix(panel);
+               queue.push({ pass, nullptr, nullptr, {{}}, [=]() { compact->render(mode, vertices, indices, stride, nTriangles, modelViewMatrix, blue, edgeWidth); } });
+          };
+
+          if(panels[Panel::TRIANGLE_COLORS] && compact->hasTriangleColors()) pushCompact("triangle colors", CompactColors::Mode::TRIANGLE_COLORS, Panel::TRIANGLE_COLORS);
+          if(panels[Panel::EDGES] && compact->hasSeamColors()) pushCompact("edges", CompactColors::Mode::EDGES, Panel::EDGES);
+          if(panels[Panel::PATCHES] && compact->hasTriangleColors() && compact->hasSeamColors()) pushCompact("patches", CompactColors::Mode::PATCHES, Panel::PATCHES);
+     }
+}
+
+bool PanelRenderer::reload(const std::string& path) {
+     for(auto& file : m_shaderFiles) {
+          if(file.path != path) continue;
+          std::cout << "INFO: Reloading " << path << '.' << std::endl;
+          if(reload_shader(file.shader, path)) drop(file.programs);
+          return true;
+     }
+     auto& s = *m_shaders;
+     for(auto& header : m_headers) {
+          if(std::get<1>(header) != path) continue;
+          std::cout << "INFO: Reloading " << path << " and recompiling all shaders." << std::endl;
+          if(reload_header(std::get<0>(header), path, { s.ed_fr.getId(), s.ed_gm.getId(), s.ed_vx.getId(), s.hl_fr.getId(), s.lb_te.getId(), s.nm_gm.getId(), s.pt_vx.getId(), s.pt_gm.getId(), s.pt_fr.getId(), s.qp_tc.getId(), s.qp_te.getId(), s.si_fr.getId(), s.si_gm.getId(), s.sm_fr.getId(), s.sm_vx.getId(), s.tr_fr.getId(), s.tr_gm.getId(), s.tr_vx.getId(), s.wf_fr.getId(), s.wf_gm.getId() })) {
+               m_programs.addInclude(path);
+               drop({ &m_edp, &m_lmp, &m_pcp, &m_ptc, &m_qpp, &m_tmp, &m_trp, &m_wfp });
+          }
+          return true;
+     }
+     return false;
+}
+
+void PanelRenderer::require(const Panels& panels) {
+     auto& s = *m_shaders;
+     if((panels[Panel::MESH] && m_budget == 0) || panels[Panel::TRIANGLE_ARRAY]) make(m_tmp, "triangle mesh", s.sm_vx, s.nm_gm, s.sm_fr);
+     if(panels[Panel::QUINTIC] && m_tolerance > 0) make(m_qpp, "adaptive quintic spline surface", s.sm_vx, s.qp_tc, s.qp_te, s.hl_fr);
+     if(panels[Panel::QUINTIC] && m_tolerance == 0) make(m_qpp, "quintic spline surface", s.sm_vx, s.qp_te, s.hl_fr);
+     if(panels[Panel::LOOP_BOX_SPLINE]) make(m_lmp, "loop box spline mesh", s.sm_vx, s.lb_te, s.nm_gm, s.sm_fr);
+     if(panels[Panel::POINT_CLOUD]) make(m_pcp, "point cloud", s.sm_vx, s.si_gm, s.si_fr);
+     if(panels[Panel::WIREFRAME]) make(m_wfp, "wireframe triangle mesh", s.sm_vx, s.wf_gm, s.wf_fr);
+     if(panels[Panel::TRIANGLE_COLORS] && !m_compact) make(m_trp, "triangle colors mesh", s.tr_vx, s.tr_gm, s.tr_fr);
+     if(panels[Panel::EDGES] && !m_compact) make(m_edp, "edges triangle mesh", s.ed_vx, s.ed_gm, s.ed_fr);
+     if(panels[Panel::PATCHES] && !m_compact) make(m_ptc, "colored patches mesh", s.pt_vx, s.pt_gm, s.pt_fr);
+}
+
+}//namespace happah
+
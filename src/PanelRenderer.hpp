@@ -0,0 +1,165 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics.hpp>
+#include <glm/glm.hpp>
+#include <array>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "CompactColors.hpp"
+#include "Meshlets.hpp"
+#include "Options.hpp"
+#include "Panels.hpp"
+#include "Profiler.hpp"
+#include "ProgramCache.hpp"
+#include "RenderQueue.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+struct PanelBuffers;
+
+struct PanelFrame;
+
+class PanelRenderer;
+
+struct PanelShaders;//NOTE: Defined with the renderer.
+
+//NOTE: Returns the offset of the panel in the grid of panels, whose cells are the lengths of the bounding box of the model plus the padding.
+Vector3D make_panel_offset(Panel panel, const Vector3D& lengths, const Vector3D& padding);
+
+//NOTE: Returns the length in pixels of the diagonal of the screen-space bounding rectangle of the box.
+hpreal make_projected_size(const Point3D& lower, const Point3D& upper, const glm::mat4& projectionMatrix, const glm::mat4& modelViewMatrix, const Vector2D& viewportSize);
+
+//DEFINITIONS
+
+//NOTE: The buffers and render contexts from which the panels of one mesh are drawn.  A panel is only drawn once the buffers that it needs are made.
+struct PanelBuffers {
+     //NOTE: Level l of the mesh, wireframe and point cloud panels is lods[l - 1]; level 0 is the mesh itself.
+     struct Lod {
+          std::unique_ptr<Buffer> vertices;
+          std::unique_ptr<Buffer> indices;
+          std::unique_ptr<RenderContext> context;
+          std::unique_ptr<Buffer> points;
+          hpuint nPoints;
+          hpuint nTriangles;
+          hpreal spacing;//of the points
+
+     };//Lod
+
+     std::unique_ptr<Buffer> bv0;//vertices of the mesh
+     std::unique_ptr<Buffer> bv1;//control points of the quintic spline surface
+     std::unique_ptr<Buffer> bv2;//control points of the loop box spline mesh
+     std::unique_ptr<Buffer> bv3;//corners of the triangle array
+     std::unique_ptr<Buffer> bi0;
+     std::unique_ptr<Buffer> bi1;
+     std::unique_ptr<Buffer> bi2;
+     std::unique_ptr<Buffer> be3;//edge colors of the corners
+     std::unique_ptr<Buffer> bc3;//vertex colors of the corners
+     std::unique_ptr<Buffer> bt3;//triangle colors of the corners
+     std::vector<hpcolor> ce3;//NOTE: The contents of be3 and bc3, which are kept so that a highlight never reads a buffer back.
+     std::vector<hpcolor> cc3;
+     std::unique_ptr<CompactColors> compact;
+     std::vector<Lod> lods;
+     hpuint nBoxPatches = 0;
+     hpuint nPoints = 0;//vertices of the mesh
+     hpuint nQuinticPatches = 0;
+     hpuint nTriangles = 0;
+     std::unique_ptr<RenderContext> rc0;
+     std::unique_ptr<RenderContext> rc1;
+     std::unique_ptr<RenderContext> rc2;
+     std::unique_ptr<MeshletStreamer> streamer;//NOTE: With a budget, the mesh panel is drawn from meshlets instead of bv0.
+
+};//PanelBuffers
+
+//NOTE: What a frame draws the panels with.  Every panel draws the model, whose bounding box is given, translated by its offset.
+struct PanelFrame {
+     Point3D lower;//of the bounding box of the model
+     hpuint meshLevel = 0;//level of detail of the mesh panel
+     std::array<Vector3D, Panels::SIZE> offsets;
+     hpuint pointLevel = 0;
+     PrimitiveCounter* primitives = nullptr;//counts the triangles of the adaptive tessellation if not null
+     glm::mat4 projectionMatrix;
+     hpreal radius;//of the points of level 0
+     Point3D upper;
+     glm::mat4 viewMatrix;
+     Vector2D viewportSize;
+     hpuint wireframeLevel = 0;
+
+};//PanelFrame
+
+//NOTE: The shaders, programs and vertex array with which the panels of a mesh are drawn.  A program is only made when a panel that needs it is first shown.  The shader files and the headers that they include can be reloaded while the programs are in use.
+class PanelRenderer {
+public:
+     PanelRenderer(const Options& options);
+
+     PanelRenderer(const PanelRenderer& renderer) = delete;
+
+     ~PanelRenderer();
+
+     PanelRenderer& operator=(const PanelRenderer& renderer) = delete;
+
+     const ProgramCache& getProgramCache() const { return m_programs; }
+
+     //NOTE: Returns the shader files and headers that reload accepts.
+     std::vector<std::string> getShaderPaths() const;
+
+     VertexArray& getVertexArray() { return m_vertexArray; }
+
+     //NOTE: Pushes a draw item for every given panel whose program and buffers are made.
+     void push(RenderQueue& queue, const PanelBuffers& buffers, const PanelFrame& frame, const Panels& panels);
+
+     //NOTE: Returns false if path is neither a shader file nor a header.  Otherwise, the shader or, for a header, every shader is compiled again, and the programs that use it are made again by the next require.  If a shader does not compile, it is reported, the previous source is kept, and the programs are kept.
+     bool reload(const std::string& path);
+
+     //NOTE: Makes the programs that the given panels need.  Nothing is made twice.
+     void require(const Panels& panels);
+
+private:
+     struct ShaderFile {
+          std::string path;
+          GLuint shader;
+          std::vector<std::unique_ptr<Program>*> programs;//programs that the shader is linked into
+
+     };//ShaderFile
+
+     VertexArray m_vertexArray;//NOTE: Declared first because the render contexts are made from it.
+     std::size_t m_budget;
+     bool m_compact;
+     std::unique_ptr<Program> m_edp;
+     std::vector<std::tuple<std::string, std::string> > m_headers;//name and path
+     std::unique_ptr<Program> m_lmp;
+     std::unique_ptr<Program> m_pcp;
+     ProgramCache m_programs;
+     std::unique_ptr<Program> m_ptc;
+     std::unique_ptr<Program> m_qpp;
+     RenderContext m_rc30;
+     RenderContext m_rc31;
+     RenderContext m_rc4;
+     std::vector<ShaderFile> m_shaderFiles;
+     std::unique_ptr<PanelShaders> m_shaders;//NOTE: Made after the headers have been loaded.
+     std::unordered_map<std::unique_ptr<Program>*, std::unique_ptr<Program> > m_stale;//NOTE: A program that is dropped because one of its files changed is kept until it has been made again; if the new program does not link, the old one is restored.
+     std::unique_ptr<Program> m_tmp;
+     hpreal m_tolerance;
+     std::unique_ptr<Program> m_trp;
+     std::unique_ptr<Program> m_wfp;
+
+     void drop(const std::vector<std::unique_ptr<Program>*>& programs);
+
+     template<class... Shaders>
+     void make(std::unique_ptr<Program>& program, const std::string& label, Shaders&... shaders);
+
+};//PanelRenderer
+
+}//namespace happah
+
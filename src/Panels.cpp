@@ -0,0 +1,36 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Panels.hpp"
+
+namespace happah {
+
+static const char* const PANEL_NAMES[Panels::SIZE] = { "mesh", "triangles", "quintic", "boxes", "points", "wireframe", "colors", "edges", "patches" };
+
+Panels make_panels(const std::string& names) {
+     auto panels = Panels(false);
+     auto begin = std::string::size_type(0);
+     while(begin <= names.size()) {
+          auto end = std::min(names.find(',', begin), names.size());
+          auto name = names.substr(begin, end - begin);
+          if(name == "all") panels = Panels(true);
+          else if(!name.empty()) {
+               auto i = hpuint(0);
+               while(i < Panels::SIZE && name != PANEL_NAMES[i]) ++i;
+               if(i == Panels::SIZE) throw std::runtime_error("Unknown panel '" + name + "'.");
+               panels.setVisible(Panel(i), true);
+          }
+          begin = end + 1;
+     }
+     return panels;
+}
+
+std::string to_string(Panel panel) { return PANEL_NAMES[hpuint(panel)]; }
+
+}//namespace happah
+
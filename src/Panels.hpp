@@ -0,0 +1,45 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <bitset>
+#include <string>
+
+namespace happah {
+
+//DECLARATIONS
+
+//NOTE: The order of the panels determines their hotkeys (1 to 9).
+enum class Panel : hpuint { MESH, TRIANGLE_ARRAY, QUINTIC, LOOP_BOX_SPLINE, POINT_CLOUD, WIREFRAME, TRIANGLE_COLORS, EDGES, PATCHES };
+
+class Panels;
+
+Panels make_panels(const std::string& names);//comma-separated list of panel names
+
+std::string to_string(Panel panel);
+
+//DEFINITIONS
+
+class Panels {
+public:
+     static constexpr hpuint SIZE = 9;
+
+     Panels(bool visible = true) { if(visible) m_visible.set(); }
+
+     bool operator[](Panel panel) const { return m_visible[hpuint(panel)]; }
+
+     void setVisible(Panel panel, bool visible) { m_visible[hpuint(panel)] = visible; }
+
+     void toggle(Panel panel) { m_visible.flip(hpuint(panel)); }
+
+private:
+     std::bitset<SIZE> m_visible;
+
+};//Panels
+
+}//namespace happah
+
@@ -0,0 +1,59 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <zlib.h>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "Png.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+static void write_chunk(std::ofstream& stream, const char* type, const unsigned char* data, std::size_t size) {
+     auto put = [&](std::uint32_t value) {
+          unsigned char bytes[4] = { (unsigned char)(value >> 24), (unsigned char)(value >> 16), (unsigned char)(value >> 8), (unsigned char)value };
+          stream.write((const char*)bytes, 4);
+     };
+     put(std::uint32_t(size));
+     stream.write(type, 4);
+     stream.write((const char*)data, size);
+     auto crc = crc32(0, (const Bytef*)type, 4);
+     if(size) crc = crc32(crc, data, uInt(size));//NOTE: crc32 returns the initial value if data is null.
+     put(std::uint32_t(crc));
+}
+
+void write_png(const std::string& path, hpuint width, hpuint height, const unsigned char* pixels) {
+     TraceZone zone("write png");
+     auto stride = std::size_t(3) * width;
+
+     //NOTE: Every row starts with its filter type; no row is filtered.
+     auto rows = std::vector<unsigned char>((stride + 1) * height);
+     for(auto y = std::size_t(0); y < height; ++y) {
+          auto row = &rows[(stride + 1) * y];
+          row[0] = 0;
+          std::memcpy(row + 1, &pixels[stride * (height - 1 - y)], stride);
+     }
+     auto size = compressBound(uLong(rows.size()));
+     auto data = std::vector<unsigned char>(size);
+     if(compress2(data.data(), &size, rows.data(), uLong(rows.size()), Z_BEST_SPEED) != Z_OK) throw std::runtime_error("Failed to compress " + path + '.');
+
+     unsigned char header[13] = { (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8), (unsigned char)width, (unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8), (unsigned char)height, 8, 2, 0, 0, 0 };//8-bit RGB, deflate, no interlacing
+
+     std::ofstream stream(path, std::ios::binary);
+     if(!stream) throw std::runtime_error("Failed to open " + path + '.');
+     stream.write("\x89PNG\r\n\x1a\n", 8);
+     write_chunk(stream, "IHDR", header, sizeof(header));
+     write_chunk(stream, "IDAT", data.data(), size);
+     write_chunk(stream, "IEND", nullptr, 0);
+     zone.addBytes(std::size_t(stream.tellp()));
+     if(!stream) throw std::runtime_error("Failed to write " + path + '.');
+}
+
+}//namespace happah
+
@@ -0,0 +1,19 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <string>
+
+namespace happah {
+
+//DECLARATIONS
+
+//NOTE: Writes an 8-bit RGB image whose rows are stored from bottom to top, as glReadPixels returns them, to a PNG file.
+void write_png(const std::string& path, hpuint width, hpuint height, const unsigned char* pixels);
+
+}//namespace happah
+
@@ -0,0 +1,145 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include "Profiler.hpp"
+
+namespace happah {
+
+static double to_milliseconds(Profiler::Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+Statistics make_statistics(std::vector<double> samples) {
+     auto statistics = Statistics();
+     if(samples.empty()) return statistics;
+     std::sort(std::begin(samples), std::end(samples));
+     auto n = samples.size();
+     statistics.max = samples.back();
+     statistics.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+     statistics.min = samples.front();
+     statistics.p99 = samples[std::min(n - 1, (99 * n + 99) / 100 - 1)];
+     return statistics;
+}
+
+PrimitiveCounter::PrimitiveCounter() { glGenQueries(2, m_queries); }
+
+PrimitiveCounter::~PrimitiveCounter() { glDeleteQueries(2, m_queries); }
+
+//NOTE: If the count of two frames ago is not available yet, the previous count is kept rather than waiting for it.
+void PrimitiveCounter::begin() {
+     if(m_pending[m_current]) {
+          auto available = GLuint(GL_FALSE);
+          glGetQueryObjectuiv(m_queries[m_current], GL_QUERY_RESULT_AVAILABLE, &available);
+          if(available) glGetQueryObjectui64v(m_queries[m_current], GL_QUERY_RESULT, &m_count);
+     }
+     glBeginQuery(GL_PRIMITIVES_GENERATED, m_queries[m_current]);
+}
+
+void PrimitiveCounter::end() {
+     glEndQuery(GL_PRIMITIVES_GENERATED);
+     m_pending[m_current] = true;
+     m_current ^= 1;
+}
+
+Profiler::Profiler(bool enabled, bool blocking)
+     : m_blocking(blocking), m_enabled(enabled) {}
+
+Profiler::~Profiler() { for(auto& pass : m_passes) glDeleteQueries(4, &pass.queries[0][0]); }
+
+void Profiler::begin(const std::string& pass) {
+     if(!m_enabled) return;
+     auto i = std::find_if(std::begin(m_passes), std::end(m_passes), [&](auto& p) { return p.name == pass; });
+     if(i == std::end(m_passes)) {
+          m_passes.emplace_back();
+          i = std::end(m_passes) - 1;
+          i->name = pass;
+          glGenQueries(4, &i->queries[0][0]);
+     }
+     m_current = hpuint(std::distance(std::begin(m_passes), i));
+     glQueryCounter(i->queries[m_parity][0], GL_TIMESTAMP);
+     i->start = Clock::now();
+}
+
+void Profiler::beginFrame() {
+     if(!m_enabled) return;
+     m_frameStart = Clock::now();
+     if(m_frames.empty()) m_start = m_frameStart;
+}
+
+void Profiler::end() {
+     if(!m_enabled) return;
+     auto& pass = m_passes[m_current];
+     pass.cpu.push_back(to_milliseconds(Clock::now() - pass.start));
+     glQueryCounter(pass.queries[m_parity][1], GL_TIMESTAMP);
+     pass.pending[m_parity] = true;
+}
+
+void Profiler::endFrame() {
+     if(!m_enabled) return;
+     if(m_blocking) {
+          glFinish();
+          m_frames.push_back(to_milliseconds(Clock::now() - m_frameStart));
+          read(m_parity, true);
+          return;
+     }
+     auto now = Clock::now();
+     m_frames.push_back(to_milliseconds(now - ((m_frames.empty()) ? m_frameStart : m_frameEnd)));
+     m_frameEnd = now;
+     read(m_parity ^ 1, false);
+     m_parity ^= 1;
+}
+
+void Profiler::finish() {
+     if(!m_enabled) return;
+     glFinish();
+     m_end = Clock::now();
+     read(m_parity ^ 1, true);
+}
+
+double Profiler::getThroughput() const {
+     auto seconds = std::chrono::duration<double>(m_end - m_start).count();
+     return (seconds > 0.0) ? double(m_frames.size()) / seconds : 0.0;
+}
+
+//NOTE: A start timestamp is written before its end timestamp, so the start is available once the end is.
+void Profiler::read(hpuint parity, bool wait) {
+     for(auto& pass : m_passes) {
+          if(!pass.pending[parity]) continue;
+          pass.pending[parity] = false;
+          auto available = GLuint(GL_TRUE);
+          if(!wait) glGetQueryObjectuiv(pass.queries[parity][1], GL_QUERY_RESULT_AVAILABLE, &available);
+          if(!available) {
+               ++m_nSkipped;
+               continue;
+          }
+          GLuint64 start, end;
+          glGetQueryObjectui64v(pass.queries[parity][0], GL_QUERY_RESULT, &start);
+          glGetQueryObjectui64v(pass.queries[parity][1], GL_QUERY_RESULT, &end);
+          pass.gpu.push_back(double(end - start) * 1e-6);
+     }
+}
+
+void Profiler::report(std::ostream& stream) const {
+     auto print = [&](const std::string& name, const std::vector<double>& samples) {
+          auto statistics = make_statistics(samples);
+          stream << "  " << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(3) << std::setw(10) << statistics.min << std::setw(10) << statistics.median << std::setw(10) << statistics.p99 << std::setw(10) << statistics.max << '\n';
+     };
+
+     stream << "INFO: " << m_frames.size() << " frames (milliseconds)\n";
+     stream << "  " << std::left << std::setw(24) << "" << std::right << std::setw(10) << "min" << std::setw(10) << "median" << std::setw(10) << "p99" << std::setw(10) << "max" << '\n';
+     print("frame", m_frames);
+     for(auto& pass : m_passes) {
+          print(pass.name + " (cpu)", pass.cpu);
+          print(pass.name + " (gpu)", pass.gpu);
+     }
+     if(m_end != Clock::time_point()) stream << "INFO: " << std::setprecision(1) << getThroughput() << " frames per second\n";
+     if(m_nSkipped) stream << "INFO: " << m_nSkipped << " GPU times were not available one frame later and were skipped.\n";
+     stream.flush();
+}
+
+}//namespace happah
+
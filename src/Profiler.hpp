@@ -0,0 +1,122 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics/glad.h>
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+struct Statistics;
+
+class PrimitiveCounter;
+
+class Profiler;
+
+Statistics make_statistics(std::vector<double> samples);
+
+//DEFINITIONS
+
+struct Statistics {
+     double max = 0.0;
+     double median = 0.0;
+     double min = 0.0;
+     double p99 = 0.0;
+
+};//Statistics
+
+//NOTE: Counts the primitives generated between begin and end.  A count is read back two frames later if it is available by then, so that the pipeline does not stall; otherwise it is skipped.
+class PrimitiveCounter {
+public:
+     PrimitiveCounter();
+
+     PrimitiveCounter(const PrimitiveCounter& counter) = delete;
+
+     ~PrimitiveCounter();
+
+     PrimitiveCounter& operator=(const PrimitiveCounter& counter) = delete;
+
+     void begin();
+
+     void end();
+
+     GLuint64 getCount() const { return m_count; }
+
+private:
+     GLuint64 m_count = 0;
+     hpuint m_current = 0;
+     bool m_pending[2] = { false, false };
+     GLuint m_queries[2];
+
+};//PrimitiveCounter
+
+//NOTE: Measures the CPU time and, through timestamp queries, the GPU time of named passes.  A blocking profiler reads the results back at the end of every frame, which stalls the pipeline, and a frame lasts until the GPU has finished it.  A non-blocking profiler reads the queries of the previous frame at the end of a frame if they are available by then and skips them otherwise, as the primitive counter does, and a frame lasts from the end of the previous frame so that frames that overlap on the GPU are measured by their throughput.  A disabled profiler does nothing.
+class Profiler {
+public:
+     using Clock = std::chrono::steady_clock;
+
+     Profiler(bool enabled = true, bool blocking = true);
+
+     Profiler(const Profiler& profiler) = delete;
+
+     ~Profiler();
+
+     Profiler& operator=(const Profiler& profiler) = delete;
+
+     void begin(const std::string& pass);
+
+     void beginFrame();
+
+     void end();
+
+     void endFrame();
+
+     //NOTE: Waits for the GPU, reads the pending queries and stops the clock of the throughput.
+     void finish();
+
+     hpuint getNumberOfSkipped() const { return m_nSkipped; }//GPU times that were not available one frame later
+
+     double getThroughput() const;//frames per second from the first frame until finish
+
+     bool isEnabled() const { return m_enabled; }
+
+     void report(std::ostream& stream) const;
+
+private:
+     struct Pass {
+          std::vector<double> cpu;//milliseconds
+          std::vector<double> gpu;//milliseconds
+          std::string name;
+          bool pending[2] = { false, false };//per frame parity
+          GLuint queries[2][2];//per frame parity, the start and the end timestamp
+          Clock::time_point start;
+     };
+
+     bool m_blocking;
+     hpuint m_current;
+     bool m_enabled;
+     Clock::time_point m_end;
+     std::vector<double> m_frames;//milliseconds
+     Clock::time_point m_frameEnd;//of the previous frame
+     Clock::time_point m_frameStart;
+     hpuint m_nSkipped = 0;
+     hpuint m_parity = 0;
+     std::vector<Pass> m_passes;
+     Clock::time_point m_start;
+
+     //NOTE: Reads the GPU times of the passes that were measured in the frame with the given parity; if wait is false, the times that are not available yet are skipped.
+     void read(hpuint parity, bool wait);
+
+};//Profiler
+
+}//namespace happah
+
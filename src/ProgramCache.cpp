@@ -0,0 +1,113 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sys/stat.h>
+#include <vector>
+
+#include "ProgramCache.hpp"
+
+namespace happah {
+
+static bool make_directories(const std::string& path) {
+     for(auto i = path.find('/', 1); ; i = path.find('/', i + 1)) {
+          auto directory = path.substr(0, i);
+          if(mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) return false;
+          if(i == std::string::npos) return true;
+     }
+}
+
+ProgramCache::ProgramCache(std::string directory, bool enabled)
+     : m_directory(std::move(directory)), m_enabled(enabled && !m_directory.empty()), m_seed(14695981039346656037ull) {
+     for(auto name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+          auto value = (const char*)glGetString(name);
+          hash(m_seed, (value) ? value : "");
+     }
+     if(m_enabled && !make_directories(m_directory)) {
+          std::cerr << "WARNING: Failed to create program cache " << m_directory << ".\n";
+          m_enabled = false;
+     }
+}
+
+void ProgramCache::addInclude(const std::string& path) {
+     std::ifstream stream(path);
+     hash(m_seed, std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+}
+
+std::string ProgramCache::get_source(GLuint shader) {
+     auto length = GLint(0);
+     glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &length);
+     auto source = std::string(length, '\0');
+     if(length) glGetShaderSource(shader, length, nullptr, &source[0]);
+     return source;
+}
+
+//NOTE: 64-bit FNV-1a.
+void ProgramCache::hash(std::uint64_t& key, const std::string& text) {
+     for(auto c : text) {
+          key ^= std::uint8_t(c);
+          key *= 1099511628211ull;
+     }
+     key ^= 0xff;//separator so that the concatenation of two texts does not collide with another split
+     key *= 1099511628211ull;
+}
+
+bool ProgramCache::is_compiled(GLuint shader) {
+     auto status = GLint(GL_FALSE);
+     glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+     return status == GL_TRUE;
+}
+
+std::string ProgramCache::make_directory() {
+     if(auto cache = std::getenv("XDG_CACHE_HOME")) return std::string(cache) + "/happah/programs";
+     if(auto home = std::getenv("HOME")) return std::string(home) + "/.cache/happah/programs";
+     return std::string();
+}
+
+//NOTE: The file contains the binary format followed by the binary.  A binary the driver rejects, for example after a driver update, leaves the program unlinked.
+bool ProgramCache::read(const std::string& path, GLuint program) {
+     std::ifstream stream(path, std::ios::binary);
+     auto format = GLenum(0);
+     if(!stream.read((char*)&format, sizeof(format))) return false;
+     auto binary = std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+     if(binary.empty()) return false;
+     glProgramBinary(program, format, binary.data(), GLsizei(binary.size()));
+     while(glGetError() != GL_NO_ERROR);
+     auto status = GLint(GL_FALSE);
+     glGetProgramiv(program, GL_LINK_STATUS, &status);
+     return status == GL_TRUE;
+}
+
+std::string ProgramCache::to_string(std::uint64_t key) {
+     char buffer[17];
+     std::snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)key);
+     return buffer;
+}
+
+void ProgramCache::write(const std::string& path, GLuint program) {
+     auto length = GLint(0);
+     glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+     if(length == 0) return;
+     auto binary = std::vector<char>(length);
+     auto format = GLenum(0);
+     glGetProgramBinary(program, length, nullptr, &format, binary.data());
+     auto temporary = path + ".tmp";
+     std::ofstream stream(temporary, std::ios::binary);
+     stream.write((const char*)&format, sizeof(format));
+     stream.write(binary.data(), binary.size());
+     stream.close();
+     if(!stream || std::rename(temporary.c_str(), path.c_str()) != 0) {
+          std::remove(temporary.c_str());
+          std::cerr << "WARNING: Failed to write program cache " << path << ".\n";
+     }
+}
+
+}//namespace happah
+
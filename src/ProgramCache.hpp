@@ -0,0 +1,83 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+#include "Tracer.hpp"
+
+namespace happah {
+
+//NOTE: Stores linked programs on disk with glGetProgramBinary.  A binary is keyed on the sources of its shaders, the included headers, and the vendor, renderer and version strings of the driver.  Shaders are only compiled if a program is not found or the driver rejects its binary.
+class ProgramCache {
+public:
+     ProgramCache(std::string directory = make_directory(), bool enabled = true);
+
+     void addInclude(const std::string& path);
+
+     hpuint getNumberOfHits() const { return m_nHits; }
+
+     hpuint getNumberOfMisses() const { return m_nMisses; }
+
+     template<class... Shaders>
+     Program make_program(std::string label, Shaders&... shaders) {
+          auto key = m_seed;
+          hash(key, label);
+          for(auto& source : { get_source(shaders.getId())... }) hash(key, source);
+          auto path = m_directory + '/' + to_string(key) + ".bin";
+
+          if(m_enabled) {
+               TraceZone zone("read program binary");
+               auto program = Program(label);
+               if(read(path, program.getId())) {
+                    ++m_nHits;
+                    return program;
+               }
+          }
+          ++m_nMisses;
+          (void)std::initializer_list<int>{ (compile_once(shaders), 0)... };
+          TraceZone zone("link program");
+          auto program = happah::make_program(std::move(label), shaders...);
+          if(m_enabled) write(path, program.getId());
+          return program;
+     }
+
+     static std::string make_directory();
+
+private:
+     std::string m_directory;
+     bool m_enabled;
+     hpuint m_nHits = 0;
+     hpuint m_nMisses = 0;
+     std::uint64_t m_seed;
+
+     template<class Shader>
+     static void compile_once(Shader& shader) {
+          if(is_compiled(shader.getId())) return;
+          TraceZone zone("compile shader");
+          compile(shader);
+     }
+
+     static std::string get_source(GLuint shader);
+
+     static void hash(std::uint64_t& key, const std::string& text);
+
+     static bool is_compiled(GLuint shader);
+
+     static bool read(const std::string& path, GLuint program);
+
+     static std::string to_string(std::uint64_t key);
+
+     static void write(const std::string& path, GLuint program);
+
+};//ProgramCache
+
+}//namespace happah
+
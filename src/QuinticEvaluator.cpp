@@ -0,0 +1,364 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "QuinticEvaluator.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+static constexpr hpuint DEGREE = 5;
+static constexpr hpuint N_CONTROL_POINTS = 21;
+
+//NOTE: The Bernstein polynomials of the control points and their derivatives in the first and second parameter at the samples of a grid with the given number of segments per edge.  Every table has N_CONTROL_POINTS rows of nPadded samples; the samples past nSamples are zero so that eight samples can always be read at once.
+struct QuinticBasis {
+     hpuint nPadded;
+     hpuint nSamples;
+     std::vector<float> values;
+     std::vector<float> us;
+     std::vector<float> vs;
+
+};//QuinticBasis
+
+static hpuint get_number_of_samples(hpuint nSegments) { return (nSegments + 1) * (nSegments + 2) / 2; }
+
+//NOTE: Sample (a, b) lies at the parameters (a / nSegments, b / nSegments); the samples are stored row by row like the control points.
+static hpuint get_sample_index(hpuint nSegments, hpuint a, hpuint b) { return b * (nSegments + 1) - b * (b - 1) / 2 + a; }
+
+//NOTE: An edge is identified by the indices of its corners in increasing order.
+static std::uint64_t make_edge_key(hpindex corner0, hpindex corner1) { return (std::uint64_t(std::min(corner0, corner1)) << 32) | std::max(corner0, corner1); }
+
+//NOTE: The corners of edge k of patch p.
+static std::pair<hpindex, hpindex> get_edge(const Indices& patches, hpuint p, hpuint k) {
+     auto corners = &patches[N_CONTROL_POINTS * p];
+     if(k == 0) return std::make_pair(corners[0], corners[DEGREE]);
+     if(k == 1) return std::make_pair(corners[DEGREE], corners[N_CONTROL_POINTS - 1]);
+     return std::make_pair(corners[0], corners[N_CONTROL_POINTS - 1]);
+}
+
+static bool is_stitched(const hpuint* edges, hpuint nSegments) { return edges[0] != nSegments || edges[1] != nSegments || edges[2] != nSegments; }
+
+//NOTE: The grid coordinates (a, b) of the samples of the grid if k is 3 and otherwise of the samples of edge k from its first corner.
+static std::vector<std::pair<hpuint, hpuint> > make_sample_coordinates(hpuint nSegments, hpuint k) {
+     auto coordinates = std::vector<std::pair<hpuint, hpuint> >();
+     if(k == 3) for(auto b = hpuint(0); b <= nSegments; ++b) for(auto a = hpuint(0); a + b <= nSegments; ++a) coordinates.emplace_back(a, b);
+     else for(auto t = hpuint(0); t <= nSegments; ++t) {
+          if(k == 0) coordinates.emplace_back(t, 0);
+          else if(k == 1) coordinates.emplace_back(nSegments - t, t);
+          else coordinates.emplace_back(0, t);
+     }
+     return coordinates;
+}
+
+static QuinticBasis make_quintic_basis(hpuint nSegments, hpuint k) {
+     static const double factorials[] = { 1, 1, 2, 6, 24, 120 };
+     auto power = [](double x, int e) { return (e < 0) ? 0.0 : std::pow(x, e); };
+
+     auto coordinates = make_sample_coordinates(nSegments, k);
+     auto basis = QuinticBasis();
+     basis.nSamples = hpuint(coordinates.size());
+     basis.nPadded = (basis.nSamples + 7) & ~hpuint(7);
+     basis.values.assign(N_CONTROL_POINTS * basis.nPadded, 0.0f);
+     basis.us.assign(N_CONTROL_POINTS * basis.nPadded, 0.0f);
+     basis.vs.assign(N_CONTROL_POINTS * basis.nPadded, 0.0f);
+     for(auto s = hpuint(0); s < basis.nSamples; ++s) {
+          auto a = coordinates[s].first;
+          auto b = coordinates[s].second;
+          auto u = double(a) / nSegments;
+          auto v = double(b) / nSegments;
+          auto w = double(nSegments - a - b) / nSegments;
+          //NOTE: Control point (i, j) in row j has the exponents i of u, j of v and k of w = 1 - u - v.
+          auto c = hpuint(0);
+          for(auto j = 0; j <= int(DEGREE); ++j) for(auto i = 0; i + j <= int(DEGREE); ++i, ++c) {
+               auto k = int(DEGREE) - i - j;
+               auto coefficient = factorials[DEGREE] / (factorials[i] * factorials[j] * factorials[k]);
+               basis.values[c * basis.nPadded + s] = float(coefficient * power(u, i) * power(v, j) * power(w, k));
+               basis.us[c * basis.nPadded + s] = float(coefficient * (i * power(u, i - 1) * power(v, j) * power(w, k) - k * power(u, i) * power(v, j) * power(w, k - 1)));
+               basis.vs[c * basis.nPadded + s] = float(coefficient * (j * power(u, i) * power(v, j - 1) * power(w, k) - k * power(u, i) * power(v, j) * power(w, k - 1)));
+          }
+     }
+     return basis;
+}
+
+static void evaluate_scalar(const QuinticBasis& basis, const Point3D* points, Point3D* positions, Vector3D* normals) {
+     for(auto s = hpuint(0); s < basis.nSamples; ++s) {
+          auto position = Point3D(0.0);
+          auto u = Vector3D(0.0);
+          auto v = Vector3D(0.0);
+          for(auto c = hpuint(0); c < N_CONTROL_POINTS; ++c) {
+               position += basis.values[c * basis.nPadded + s] * points[c];
+               u += basis.us[c * basis.nPadded + s] * points[c];
+               v += basis.vs[c * basis.nPadded + s] * points[c];
+          }
+          positions[s] = position;
+          normals[s] = glm::normalize(glm::cross(u, v));
+     }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2,fma")))
+static void evaluate_avx2(const QuinticBasis& basis, const Point3D* points, Point3D* positions, Vector3D* normals) {
+     alignas(32) float out[6][8];
+     for(auto s = hpuint(0); s < basis.nSamples; s += 8) {
+          auto px = _mm256_setzero_ps(), py = _mm256_setzero_ps(), pz = _mm256_setzero_ps();
+          auto ux = _mm256_setzero_ps(), uy = _mm256_setzero_ps(), uz = _mm256_setzero_ps();
+          auto vx = _mm256_setzero_ps(), vy = _mm256_setzero_ps(), vz = _mm256_setzero_ps();
+          for(auto c = hpuint(0); c < N_CONTROL_POINTS; ++c) {
+               auto x = _mm256_set1_ps(points[c].x);
+               auto y = _mm256_set1_ps(points[c].y);
+               auto z = _mm256_set1_ps(points[c].z);
+               auto value = _mm256_loadu_ps(&basis.values[c * basis.nPadded + s]);
+               auto du = _mm256_loadu_ps(&basis.us[c * basis.nPadded + s]);
+               auto dv = _mm256_loadu_ps(&basis.vs[c * basis.nPadded + s]);
+               px = _mm256_fmadd_ps(value, x, px);
+               py = _mm256_fmadd_ps(value, y, py);
+               pz = _mm256_fmadd_ps(value, z, pz);
+               ux = _mm256_fmadd_ps(du, x, ux);
+               uy = _mm256_fmadd_ps(du, y, uy);
+               uz = _mm256_fmadd_ps(du, z, uz);
+               vx = _mm256_fmadd_ps(dv, x, vx);
+               vy = _mm256_fmadd_ps(dv, y, vy);
+               vz = _mm256_fmadd_ps(dv, z, vz);
+          }
+          auto nx = _mm256_fmsub_ps(uy, vz, _mm256_mul_ps(uz, vy));
+          auto ny = _mm256_fmsub_ps(uz, vx, _mm256_mul_ps(ux, vz));
+          auto nz = _mm256_fmsub_ps(ux, vy, _mm256_mul_ps(uy, vx));
+          auto length = _mm256_sqrt_ps(_mm256_fmadd_ps(nx, nx, _mm256_fmadd_ps(ny, ny, _mm256_mul_ps(nz, nz))));
+          _mm256_store_ps(out[0], px);
+          _mm256_store_ps(out[1], py);
+          _mm256_store_ps(out[2], pz);
+          _mm256_store_ps(out[3], _mm256_div_ps(nx, length));
+          _mm256_store_ps(out[4], _mm256_div_ps(ny, length));
+          _mm256_store_ps(out[5], _mm256_div_ps(nz, length));
+          //NOTE: The samples are stored as they are read by the mesh; the last block may be partial.
+          for(auto l = hpuint(0), n = std::min(hpuint(8), basis.nSamples - s); l < n; ++l) {
+               positions[s + l] = Point3D(out[0][l], out[1][l], out[2][l]);
+               normals[s + l] = Vector3D(out[3][l], out[4][l], out[5][l]);
+          }
+     }
+}
+
+bool is_simd_supported() {
+     static const auto supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+     return supported;
+}
+#else
+static void evaluate_avx2(const QuinticBasis& basis, const Point3D* points, Point3D* positions, Vector3D* normals) { evaluate_scalar(basis, points, positions, normals); }
+
+bool is_simd_supported() { return false; }
+#endif
+
+QuinticSamples evaluate_quintic_patches(const std::vector<Point3D>& controlPoints, const Indices& patches, const std::vector<hpuint>& segments, bool simd, hpuint nThreads) {
+     TraceZone zone("evaluate quintic patches");
+     auto nPatches = hpuint(patches.size() / N_CONTROL_POINTS);
+     if(segments.size() != nPatches) throw std::runtime_error("Expected the number of segments of every patch.");
+
+     auto edgeSegments = std::unordered_map<std::uint64_t, hpuint>();
+     for(auto p = hpuint(0); p < nPatches; ++p) {
+          if(segments[p] == 0) throw std::runtime_error("A patch needs at least one segment per edge.");
+          for(auto k = hpuint(0); k < 3; ++k) {
+               auto edge = get_edge(patches, p, k);
+               auto& nSegments = edgeSegments[make_edge_key(edge.first, edge.second)];
+               nSegments = std::max(nSegments, segments[p]);
+          }
+     }
+
+     auto samples = QuinticSamples();
+     samples.edges.resize(3 * nPatches);
+     samples.offsets.resize(nPatches + 1, 0);
+     samples.segments = segments;
+     auto bases = std::map<std::pair<hpuint, hpuint>, QuinticBasis>();//NOTE: The key is the number of segments and the edge or 3 for the grid.
+     auto addBasis = [&](hpuint nSegments, hpuint k) { if(bases.find(std::make_pair(nSegments, k)) == std::end(bases)) bases.emplace(std::make_pair(nSegments, k), make_quintic_basis(nSegments, k)); };
+     for(auto p = hpuint(0); p < nPatches; ++p) {
+          auto edges = &samples.edges[3 * p];
+          for(auto k = hpuint(0); k < 3; ++k) {
+               auto edge = get_edge(patches, p, k);
+               edges[k] = edgeSegments[make_edge_key(edge.first, edge.second)];
+          }
+          auto& n = samples.segments[p];
+          if(is_stitched(edges, n)) n = std::max(n, hpuint(3));
+          auto nSamples = get_number_of_samples(n);
+          addBasis(n, 3);
+          if(is_stitched(edges, n)) for(auto k = hpuint(0); k < 3; ++k) {
+               nSamples += edges[k] + 1;
+               addBasis(edges[k], k);
+          }
+          samples.offsets[p + 1] = samples.offsets[p] + nSamples;
+     }
+     samples.positions.resize(samples.offsets[nPatches]);
+     samples.normals.resize(samples.offsets[nPatches]);
+     zone.addBytes(samples.positions.size() * (sizeof(Point3D) + sizeof(Vector3D)));
+
+     auto evaluate = (simd && is_simd_supported()) ? evaluate_avx2 : evaluate_scalar;
+     auto nChunks = std::min(nPatches, 4 * nThreads);
+     ThreadPool pool(nThreads);
+     auto chunks = std::vector<std::future<void> >();
+     chunks.reserve(nChunks);
+     for(auto c = hpuint(0); c < nChunks; ++c) chunks.push_back(pool.submit([&, c]() {
+          auto points = std::array<Point3D, N_CONTROL_POINTS>();
+          for(auto p = std::size_t(nPatches) * c / nChunks, end = std::size_t(nPatches) * (c + 1) / nChunks; p < end; ++p) {
+               for(auto i = hpuint(0); i < N_CONTROL_POINTS; ++i) points[i] = controlPoints[patches[N_CONTROL_POINTS * p + i]];
+               auto n = samples.segments[p];
+               auto edges = &samples.edges[3 * p];
+               auto offset = samples.offsets[p];
+               evaluate(bases.find(std::make_pair(n, hpuint(3)))->second, points.data(), &samples.positions[offset], &samples.normals[offset]);
+               offset += get_number_of_samples(n);
+               if(is_stitched(edges, n)) for(auto k = hpuint(0); k < 3; ++k) {
+                    evaluate(bases.find(std::make_pair(edges[k], k))->second, points.data(), &samples.positions[offset], &samples.normals[offset]);
+                    offset += edges[k] + 1;
+               }
+          }
+     }));
+     for(auto& chunk : chunks) chunk.get();
+     return samples;
+}
+
+TriangleMesh<VertexP3> make_quintic_mesh(const QuinticSamples& samples, const Indices& patches) {
+     TraceZone zone("quintic mesh");
+     //NOTE: A sample on the boundary of a patch is identified by the indices of the corners of its edge, in increasing order, and its position on the edge as a reduced fraction measured from the first corner; a corner is an edge from a corner to itself.
+     struct Key {
+          hpindex corners[2];
+          hpuint numerator;
+          hpuint denominator;
+
+          bool operator==(const Key& key) const { return corners[0] == key.corners[0] && corners[1] == key.corners[1] && numerator == key.numerator && denominator == key.denominator; }
+
+     };//Key
+     struct Hash {
+          std::size_t operator()(const Key& key) const {
+               auto hash = std::uint64_t(14695981039346656037ull);
+               for(auto value : { key.corners[0], key.corners[1], key.numerator, key.denominator }) hash = (hash ^ value) * 1099511628211ull;
+               return std::size_t(hash);
+          }
+
+     };//Hash
+
+     auto nPatches = hpuint(samples.segments.size());
+     auto boundary = std::unordered_map<Key, hpindex, Hash>();
+     auto vertices = std::vector<VertexP3>();
+     auto indices = Indices();
+     auto sampleIndices = std::vector<hpindex>();
+     vertices.reserve(samples.positions.size());
+
+     auto make_key = [](hpindex corner0, hpindex corner1, hpuint numerator, hpuint denominator) {
+          if(numerator == 0) return Key{ { corner0, corner0 }, 0, 1 };
+          if(numerator == denominator) return Key{ { corner1, corner1 }, 0, 1 };
+          if(corner1 < corner0) {
+               std::swap(corner0, corner1);
+               numerator = denominator - numerator;
+          }
+          auto a = numerator;
+          auto b = denominator;
+          while(b) a = std::exchange(b, a % b);
+          return Key{ { corner0, corner1 }, numerator / a, denominator / a };
+     };
+
+     auto add = [&](hpuint sample) {
+          vertices.push_back(VertexP3(samples.positions[sample]));
+          return hpindex(vertices.size() - 1);
+     };
+     auto weld = [&](const Key& key, hpuint sample) {
+          auto i = boundary.find(key);
+          return (i != std::end(boundary)) ? i->second : boundary.emplace(key, add(sample)).first->second;
+     };
+     auto addTriangle = [&](hpindex i0, hpindex i1, hpindex i2) { indices.insert(std::end(indices), { i0, i1, i2 }); };
+
+     //NOTE: Triangulates the strip between a polyline on the boundary and one on the inner grid that run in the same direction, advancing on the polyline whose next segment ends first.
+     auto zip = [&](const std::vector<hpindex>& outer, const std::vector<hpindex>& inner) {
+          auto nOuter = outer.size() - 1;
+          auto nInner = inner.size() - 1;
+          for(auto i = std::size_t(0), j = std::size_t(0); i < nOuter || j < nInner; ) {
+               if(j == nInner || (i < nOuter && (2 * i + 1) * nInner <= (2 * j + 1) * nOuter)) {
+                    addTriangle(outer[i], outer[i + 1], inner[j]);
+                    ++i;
+               } else {
+                    addTriangle(outer[i], inner[j + 1], inner[j]);
+                    ++j;
+               }
+          }
+     };
+
+     std::vector<hpindex> outer[3], inner[3];
+     for(auto p = hpuint(0); p < nPatches; ++p) {
+          auto n = samples.segments[p];
+          auto edges = &samples.edges[3 * p];
+          auto stitched = is_stitched(edges, n);
+          auto edgeKey = [&](hpuint k, hpuint t, hpuint nSegments) {
+               auto edge = get_edge(patches, p, k);
+               return make_key(edge.first, edge.second, t, nSegments);
+          };
+          sampleIndices.resize(get_number_of_samples(n));
+          for(auto b = hpuint(0); b <= n; ++b) for(auto a = hpuint(0); a + b <= n; ++a) {
+               auto s = get_sample_index(n, a, b);
+               auto sample = samples.offsets[p] + s;
+               if(a > 0 && b > 0 && a + b < n) sampleIndices[s] = add(sample);
+               else if(stitched) continue;//NOTE: The edges are sampled separately.
+               else if(b == 0) sampleIndices[s] = weld(edgeKey(0, a, n), sample);
+               else if(a + b == n) sampleIndices[s] = weld(edgeKey(1, b, n), sample);
+               else sampleIndices[s] = weld(edgeKey(2, b, n), sample);
+          }
+
+          //NOTE: If the patch is stitched, only the triangles of the grid without its boundary are made here.
+          auto gap = (stitched) ? hpuint(1) : hpuint(0);
+          for(auto b = gap; b < n; ++b) for(auto a = gap; a + b + 1 + gap <= n; ++a) {
+               addTriangle(sampleIndices[get_sample_index(n, a, b)], sampleIndices[get_sample_index(n, a + 1, b)], sampleIndices[get_sample_index(n, a, b + 1)]);
+               if(a + b + 2 + gap <= n) addTriangle(sampleIndices[get_sample_index(n, a + 1, b)], sampleIndices[get_sample_index(n, a + 1, b + 1)], sampleIndices[get_sample_index(n, a, b + 1)]);
+          }
+          if(!stitched) continue;
+
+          //NOTE: The ring between the edges and the inner grid is made of three strips, each from one corner of the patch to the next.
+          auto sample = samples.offsets[p] + get_number_of_samples(n);
+          for(auto k = hpuint(0); k < 3; ++k) {
+               outer[k].clear();
+               inner[k].clear();
+               for(auto t = hpuint(0); t <= edges[k]; ++t) outer[k].push_back(weld(edgeKey(k, t, edges[k]), sample + t));
+               sample += edges[k] + 1;
+          }
+          std::reverse(std::begin(outer[2]), std::end(outer[2]));
+          for(auto i = hpuint(1); i + 1 < n; ++i) {
+               inner[0].push_back(sampleIndices[get_sample_index(n, i, 1)]);
+               inner[1].push_back(sampleIndices[get_sample_index(n, n - 1 - i, i)]);
+               inner[2].push_back(sampleIndices[get_sample_index(n, 1, n - 1 - i)]);
+          }
+          for(auto k = hpuint(0); k < 3; ++k) zip(outer[k], inner[k]);
+     }
+     return TriangleMesh<VertexP3>(std::move(vertices), std::move(indices));
+}
+
+std::vector<hpuint> make_quintic_segments(const std::vector<Point3D>& controlPoints, const Indices& patches, hpreal deviation, hpuint maxSegments) {
+     auto nPatches = hpuint(patches.size() / N_CONTROL_POINTS);
+     auto segments = std::vector<hpuint>(nPatches);
+     for(auto p = hpuint(0); p < nPatches; ++p) {
+          auto point = [&](hpuint c) { return controlPoints[patches[N_CONTROL_POINTS * p + c]]; };
+          auto p0 = point(0);
+          auto p1 = point(DEGREE);
+          auto p2 = point(N_CONTROL_POINTS - 1);
+          auto distance = hpreal(0);
+          auto c = hpuint(0);
+          for(auto j = hpuint(0); j <= DEGREE; ++j) for(auto i = hpuint(0); i + j <= DEGREE; ++i, ++c) {
+               auto linear = (hpreal(DEGREE - i - j) * p0 + hpreal(i) * p1 + hpreal(j) * p2) / hpreal(DEGREE);
+               distance = std::max(distance, glm::length(point(c) - linear));
+          }
+          segments[p] = hpuint(std::max(hpreal(1), std::min(hpreal(maxSegments), std::ceil(std::sqrt(distance / deviation)))));//NOTE: Clamped before the conversion, which is undefined for values that do not fit.
+     }
+     return segments;
+}
+
+}//namespace happah
+
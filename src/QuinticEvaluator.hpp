@@ -0,0 +1,44 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+struct QuinticSamples;
+
+//NOTE: Evaluates the position and normal of every quintic Bezier triangle patch at the points of a uniform grid with segments[p] segments per edge of patch p, in parallel across patches on the given number of threads.  A patch is given by 21 indices into the control points, row by row from the edge between its first two corners to its third corner.  An edge that two patches share through the indices of its corners gets the larger number of segments of the two; a patch with an edge that has more segments than the patch is also sampled along its edges, and its grid has at least three segments so that there are inner samples to stitch the edges to.  If simd is true and the processor supports AVX2, eight samples are evaluated at once.
+QuinticSamples evaluate_quintic_patches(const std::vector<Point3D>& controlPoints, const Indices& patches, const std::vector<hpuint>& segments, bool simd = true, hpuint nThreads = std::max(1u, std::thread::hardware_concurrency()));
+
+bool is_simd_supported();//true if evaluate_quintic_patches can use AVX2
+
+//NOTE: Triangulates the samples of every patch.  Samples on an edge or at a corner that patches share through the indices of their corners are merged, and the inner grid of a patch is stitched to the samples of edges that have more segments, so the tessellation of a closed surface is closed.
+TriangleMesh<VertexP3> make_quintic_mesh(const QuinticSamples& samples, const Indices& patches);
+
+//NOTE: Returns for every patch the number of segments per edge, between 1 and maxSegments, with which the triangles of its tessellation stay within about deviation of the patch.  The distance of a patch from the triangle of its corners is bounded by the largest distance of its control points from that triangle and shrinks with the square of the number of segments.
+std::vector<hpuint> make_quintic_segments(const std::vector<Point3D>& controlPoints, const Indices& patches, hpreal deviation, hpuint maxSegments = 32);
+
+//DEFINITIONS
+
+struct QuinticSamples {
+     std::vector<hpuint> edges;//segments of the edges of every patch from its first to its second corner, from its second to its third and from its first to its third
+     std::vector<Vector3D> normals;
+     std::vector<hpuint> offsets;//of the first sample of every patch; the last entry is the number of samples
+     std::vector<Point3D> positions;
+     std::vector<hpuint> segments;//of the grid of every patch; if an edge has other segments, the samples of the three edges follow the grid
+
+};//QuinticSamples
+
+}//namespace happah
+
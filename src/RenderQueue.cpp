@@ -0,0 +1,113 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <functional>
+
+#include "RenderQueue.hpp"
+
+namespace happah {
+
+static_assert(sizeof(FrameUniforms) == 2 * 64 + 16 + 16, "FrameUniforms must match the std140 layout of the Frame block.");
+
+//NOTE: The items with a program come first, sorted by program and then by buffers.  Pointers to different objects are compared with std::less, which orders them totally.
+static bool precedes(const RenderQueue::Item& a, const RenderQueue::Item& b) {
+     auto less = std::less<const void*>();
+     if((a.program == nullptr) != (b.program == nullptr)) return b.program == nullptr;
+     if(a.program != b.program) return less(a.program, b.program);
+     for(auto i = hpuint(0); i < 4; ++i) if(a.buffers[i] != b.buffers[i]) return less(a.buffers[i], b.buffers[i]);
+     return false;
+}
+
+//NOTE: Counts the program and buffer bindings that drawing the items in the given order makes.
+static hpuint count_changes(const std::vector<RenderQueue::Item>& items) {
+     auto nChanges = hpuint(0);
+     auto program = (Program*)nullptr;
+     auto buffers = std::array<Buffer*, 4>({{ nullptr, nullptr, nullptr, nullptr }});
+     for(auto& item : items) {
+          if(!item.program) {
+               program = nullptr;
+               buffers.fill(nullptr);
+               continue;
+          }
+          if(item.program != program) ++nChanges;
+          program = item.program;
+          for(auto i = hpuint(0); i < 4; ++i) {
+               if(!item.buffers[i] || item.buffers[i] == buffers[i]) continue;
+               buffers[i] = item.buffers[i];
+               ++nChanges;
+          }
+     }
+     return nChanges;
+}
+
+RenderQueue::RenderQueue(VertexArray& vertexArray)
+     : m_vertexArray(vertexArray) {
+     glGenBuffers(1, &m_buffer);
+     glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+     glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+     glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+RenderQueue::~RenderQueue() { glDeleteBuffers(1, &m_buffer); }
+
+void RenderQueue::beginFrame(const FrameUniforms& uniforms) {
+     m_items.clear();
+     m_nDrawCalls = 0;
+     m_nSkippedChanges = 0;
+     m_nStateChanges = 0;
+     glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+     glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &uniforms);
+     glBindBuffer(GL_UNIFORM_BUFFER, 0);
+     glBindBufferBase(GL_UNIFORM_BUFFER, FrameUniforms::BINDING, m_buffer);
+}
+
+void RenderQueue::submit(Profiler& profiler) {
+     //NOTE: The sort is stable so that items that share all their state are drawn in the order in which they were pushed.
+     auto nUnsorted = count_changes(m_items);
+     std::stable_sort(std::begin(m_items), std::end(m_items), precedes);
+     m_nSkippedChanges += nUnsorted - count_changes(m_items);
+
+     auto program = (Program*)nullptr;
+     auto buffers = std::array<Buffer*, 4>({{ nullptr, nullptr, nullptr, nullptr }});
+     auto bound = false;//true if the vertex array is bound
+
+     for(auto& item : m_items) {
+          profiler.begin(item.pass);
+          if(item.program) {
+               if(!bound) {
+                    activate(m_vertexArray);
+                    bound = true;
+                    ++m_nStateChanges;
+               }
+               if(item.program != program) {
+                    item.activate();
+                    program = item.program;
+                    ++m_nStateChanges;
+               }
+               for(auto i = hpuint(0); i < 4; ++i) {
+                    if(!item.buffers[i]) continue;
+                    if(item.buffers[i] != buffers[i]) {
+                         activate(*item.buffers[i], m_vertexArray, i);
+                         buffers[i] = item.buffers[i];
+                         ++m_nStateChanges;
+                    }
+               }
+          }
+          item.draw();
+          ++m_nDrawCalls;
+          if(!item.program) {
+               //NOTE: The item may have bound any program and vertex array.
+               program = nullptr;
+               buffers.fill(nullptr);
+               bound = false;
+          }
+          profiler.end();
+     }
+     m_items.clear();
+}
+
+}//namespace happah
+
@@ -0,0 +1,85 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/graphics.hpp>
+#include <glm/glm.hpp>
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Profiler.hpp"
+
+namespace happah {
+
+//DECLARATIONS
+
+struct FrameUniforms;
+
+class RenderQueue;
+
+//DEFINITIONS
+
+//NOTE: The std140 layout of the uniform block that the shaders of the viewer declare as
+//     layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+struct FrameUniforms {
+     static constexpr GLuint BINDING = 0;
+
+     glm::mat4 projectionMatrix;
+     glm::mat4 viewMatrix;
+     glm::vec4 light;
+     glm::vec2 viewportSize;
+     glm::vec2 padding;
+
+};//FrameUniforms
+
+//NOTE: Collects the draw items of a frame, sorts them by program and vertex buffers, and draws them, skipping the bindings that are already in place.  Items without a program bind their own state and are drawn last.
+class RenderQueue {
+public:
+     struct Item {
+          std::string pass;//name under which the profiler measures the item
+          Program* program = nullptr;
+          std::function<void()> activate;//activates the program; only called if the previous item used a different program
+          std::array<Buffer*, 4> buffers = {{ nullptr, nullptr, nullptr, nullptr }};//bound to the vertex array at the bindings 0 to 3
+          std::function<void()> draw;//sets the uniforms of the item and draws it
+
+     };//Item
+
+     RenderQueue(VertexArray& vertexArray);
+
+     RenderQueue(const RenderQueue& queue) = delete;
+
+     ~RenderQueue();
+
+     RenderQueue& operator=(const RenderQueue& queue) = delete;
+
+     //NOTE: Clears the queue and the counters and updates the uniform block shared by all items.
+     void beginFrame(const FrameUniforms& uniforms);
+
+     hpuint getNumberOfDrawCalls() const { return m_nDrawCalls; }
+
+     hpuint getNumberOfSkippedChanges() const { return m_nSkippedChanges; }//program and buffer bindings that drawing the items in the order in which they were pushed would have made in addition
+
+     hpuint getNumberOfStateChanges() const { return m_nStateChanges; }
+
+     void push(Item item) { m_items.push_back(std::move(item)); }
+
+     void submit(Profiler& profiler);
+
+private:
+     GLuint m_buffer;
+     std::vector<Item> m_items;
+     hpuint m_nDrawCalls = 0;
+     hpuint m_nSkippedChanges = 0;
+     hpuint m_nStateChanges = 0;
+     VertexArray& m_vertexArray;
+
+};//RenderQueue
+
+}//namespace happah
+
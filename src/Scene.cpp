@@ -0,0 +1,149 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "GlslProgram.hpp"
+#include "Scene.hpp"
+#include "Tracer.hpp"
+
+namespace happah {
+
+static const char* const SCENE_VERTEX_SHADER = R"(
+#version 430 core
+
+layout(std140, binding = 0) uniform Frame { mat4 projectionMatrix; mat4 viewMatrix; vec4 light; vec2 viewportSize; };
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in mat4 modelMatrix;//per instance
+
+out vec3 vPosition;
+
+void main() {
+     vec4 p = viewMatrix * modelMatrix * vec4(position, 1.0);
+     vPosition = p.xyz;
+     gl_Position = projectionMatrix * p;
+}
+)";
+
+std::uint64_t make_hash(const TriangleMesh<VertexP3>& mesh) {
+     auto hash = std::uint64_t(14695981039346656037ull);//FNV-1a
+     auto add = [&](const void* data, std::size_t n) {
+          auto bytes = static_cast<const unsigned char*>(data);
+          for(auto i = std::size_t(0); i < n; ++i) hash = (hash ^ bytes[i]) * 1099511628211ull;
+     };
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     auto nVertices = std::uint64_t(vertices.size());
+     add(&nVertices, sizeof(nVertices));
+     add(vertices.data(), vertices.size() * sizeof(VertexP3));
+     add(indices.data(), indices.size() * sizeof(hpindex));
+     return hash;
+}
+
+std::vector<Vector3D> make_scene_layout(const std::vector<std::tuple<Point3D, Point3D> >& boxes) {
+     auto translations = std::vector<Vector3D>();
+     if(boxes.empty()) return translations;
+     translations.reserve(boxes.size());
+
+     auto size = Vector3D(0.0);
+     for(auto& box : boxes) size = glm::max(size, std::get<1>(box) - std::get<0>(box));
+     auto padding = hpreal(0.1) * std::max(size.x, size.y);
+     auto nColumns = hpuint(std::ceil(std::sqrt(hpreal(boxes.size()))));
+
+     //NOTE: A part is centered vertically in its row and placed right of the previous part; rows are as high as their highest part.
+     auto x = hpreal(0);
+     auto y = hpreal(0);
+     for(auto row = std::size_t(0); row < boxes.size(); row += nColumns) {
+          auto end = std::min(boxes.size(), row + nColumns);
+          auto height = hpreal(0);
+          for(auto i = row; i < end; ++i) height = std::max(height, std::get<1>(boxes[i]).y - std::get<0>(boxes[i]).y);
+          x = hpreal(0);
+          for(auto i = row; i < end; ++i) {
+               auto& lower = std::get<0>(boxes[i]);
+               auto& upper = std::get<1>(boxes[i]);
+               auto center = hpreal(0.5) * (lower + upper);
+               translations.push_back(Vector3D(x - lower.x, y - hpreal(0.5) * height - center.y, -center.z));
+               x += upper.x - lower.x + padding;
+          }
+          y -= height + padding;
+     }
+     return translations;
+}
+
+bool is_equal(const TriangleMesh<VertexP3>& mesh0, const TriangleMesh<VertexP3>& mesh1) {
+     auto& vertices0 = mesh0.getVertices();
+     auto& vertices1 = mesh1.getVertices();
+     auto& indices0 = mesh0.getIndices();
+     auto& indices1 = mesh1.getIndices();
+     return vertices0.size() == vertices1.size() && indices0 == indices1 && std::memcmp(vertices0.data(), vertices1.data(), vertices0.size() * sizeof(VertexP3)) == 0;
+}
+
+Scene::Scene() {
+     m_program = make_glsl_program("scene", { { GL_VERTEX_SHADER, SCENE_VERTEX_SHADER }, { GL_FRAGMENT_SHADER, FLAT_FRAGMENT_SHADER } });
+     glCreateBuffers(1, &m_instances);
+}
+
+Scene::~Scene() {
+     for(auto& mesh : m_meshes) {
+          glDeleteVertexArrays(1, &mesh.vertexArray);
+          glDeleteBuffers(2, mesh.buffers);
+     }
+     glDeleteBuffers(1, &m_instances);
+     glDeleteProgram(m_program);
+}
+
+void Scene::add(const TriangleMesh<VertexP3>& mesh, const std::vector<glm::mat4>& modelMatrices) {
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     TraceZone zone("upload mesh");
+     zone.addBytes(vertices.size() * sizeof(VertexP3) + indices.size() * sizeof(hpindex));
+     auto entry = Mesh();
+     entry.firstInstance = hpuint(m_modelMatrices.size());
+     entry.nIndices = hpuint(indices.size());
+     entry.nInstances = hpuint(modelMatrices.size());
+     m_modelMatrices.insert(std::end(m_modelMatrices), std::begin(modelMatrices), std::end(modelMatrices));
+     m_dirty = true;
+
+     glCreateBuffers(2, entry.buffers);
+     glNamedBufferStorage(entry.buffers[0], vertices.size() * sizeof(VertexP3), vertices.data(), 0);
+     glNamedBufferStorage(entry.buffers[1], indices.size() * sizeof(hpindex), indices.data(), 0);
+     glCreateVertexArrays(1, &entry.vertexArray);
+     auto vertexArray = entry.vertexArray;
+     glVertexArrayVertexBuffer(vertexArray, 0, entry.buffers[0], 0, sizeof(VertexP3));
+     glVertexArrayAttribFormat(vertexArray, 0, 3, GL_FLOAT, GL_FALSE, 0);
+     glVertexArrayAttribBinding(vertexArray, 0, 0);
+     glEnableVertexArrayAttrib(vertexArray, 0);
+     //NOTE: A matrix attribute takes four locations, one per column.
+     glVertexArrayVertexBuffer(vertexArray, 1, m_instances, 0, sizeof(glm::mat4));
+     glVertexArrayBindingDivisor(vertexArray, 1, 1);
+     for(auto i = 0; i < 4; ++i) {
+          glVertexArrayAttribFormat(vertexArray, 1 + i, 4, GL_FLOAT, GL_FALSE, i * sizeof(glm::vec4));
+          glVertexArrayAttribBinding(vertexArray, 1 + i, 1);
+          glEnableVertexArrayAttrib(vertexArray, 1 + i);
+     }
+     glVertexArrayElementBuffer(vertexArray, entry.buffers[1]);
+     m_meshes.push_back(entry);
+}
+
+void Scene::render(const hpcolor& modelColor) {
+     if(m_dirty) {
+          glNamedBufferData(m_instances, m_modelMatrices.size() * sizeof(glm::mat4), m_modelMatrices.data(), GL_STATIC_DRAW);
+          m_dirty = false;
+     }
+     glUseProgram(m_program);
+     glUniform4fv(glGetUniformLocation(m_program, "modelColor"), 1, glm::value_ptr(glm::vec4(modelColor)));
+     for(auto& mesh : m_meshes) {
+          glBindVertexArray(mesh.vertexArray);
+          glDrawElementsInstancedBaseInstance(GL_TRIANGLES, mesh.nIndices, GL_UNSIGNED_INT, nullptr, mesh.nInstances, mesh.firstInstance);
+     }
+     glBindVertexArray(0);
+}
+
+}//namespace happah
+
@@ -0,0 +1,72 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <happah/geometry/TriangleMesh.hpp>
+#include <happah/geometry/Vertex.hpp>
+#include <happah/graphics/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace happah {
+
+//DECLARATIONS
+
+class Scene;
+
+//NOTE: Returns a hash of the vertices and indices of the mesh; meshes with the same hash are compared with is_equal before they are shared.
+std::uint64_t make_hash(const TriangleMesh<VertexP3>& mesh);
+
+//NOTE: Places parts with the given bounding boxes from left to right in rows that run from top to bottom, with about as many rows as columns, and returns the translation of every part.
+std::vector<Vector3D> make_scene_layout(const std::vector<std::tuple<Point3D, Point3D> >& boxes);
+
+bool is_equal(const TriangleMesh<VertexP3>& mesh0, const TriangleMesh<VertexP3>& mesh1);
+
+//DEFINITIONS
+
+//NOTE: Draws meshes that appear several times in a scene with one instanced draw call per mesh.  The model matrices of the instances are vertex attributes that advance per instance and are read from one buffer; the projection matrix, the view matrix and the light are read from the frame uniform block (see FrameUniforms).
+class Scene {
+public:
+     Scene();
+
+     Scene(const Scene& scene) = delete;
+
+     ~Scene();
+
+     Scene& operator=(const Scene& scene) = delete;
+
+     //NOTE: Uploads the mesh; it is drawn once per model matrix.
+     void add(const TriangleMesh<VertexP3>& mesh, const std::vector<glm::mat4>& modelMatrices);
+
+     hpuint getNumberOfInstances() const { return hpuint(m_modelMatrices.size()); }
+
+     hpuint getNumberOfMeshes() const { return hpuint(m_meshes.size()); }
+
+     void render(const hpcolor& modelColor);
+
+private:
+     struct Mesh {
+          GLuint buffers[2];//vertices and indices
+          hpuint firstInstance;
+          hpuint nIndices;
+          hpuint nInstances;
+          GLuint vertexArray;
+
+     };//Mesh
+
+     bool m_dirty = false;//true if the model matrices have not been uploaded
+     GLuint m_instances;
+     std::vector<Mesh> m_meshes;
+     std::vector<glm::mat4> m_modelMatrices;
+     GLuint m_program;
+
+};//Scene
+
+}//namespace happah
+
@@ -0,0 +1,40 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ThreadPool.hpp"
+
+namespace happah {
+
+ThreadPool::ThreadPool(hpuint n, std::function<void()> notify)
+     : m_notify(std::move(notify)) {
+     m_threads.reserve(n);
+     for(auto i = hpuint(0); i < n; ++i) m_threads.emplace_back([this]() {
+          while(true) {
+               auto task = std::function<void()>();
+               {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [&]() { return m_stopped || !m_tasks.empty(); });
+                    if(m_stopped) return;
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop();
+               }
+               task();
+               if(m_notify) m_notify();
+          }
+     });
+}
+
+//NOTE: Tasks that have not been started yet are discarded; their futures report a broken promise.
+ThreadPool::~ThreadPool() {
+     {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_stopped = true;
+     }
+     m_condition.notify_all();
+     for(auto& thread : m_threads) thread.join();
+}
+
+}//namespace happah
+
@@ -0,0 +1,57 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace happah {
+
+//NOTE: Tasks are started in the order in which they are submitted.  Therefore, a task may block on the future of a task that was submitted before it without deadlocking the pool.
+class ThreadPool {
+public:
+     ThreadPool(hpuint n = std::max(1u, std::thread::hardware_concurrency()), std::function<void()> notify = std::function<void()>());//notify is called on the worker thread after every task
+
+     ThreadPool(const ThreadPool& pool) = delete;
+
+     ~ThreadPool();
+
+     ThreadPool& operator=(const ThreadPool& pool) = delete;
+
+     template<class Task>
+     auto submit(Task&& task) {
+          using Result = decltype(task());
+
+          auto job = std::make_shared<std::packaged_task<Result()> >(std::forward<Task>(task));
+          auto result = job->get_future();
+          {
+               std::lock_guard<std::mutex> lock(m_mutex);
+               m_tasks.emplace([job]() { (*job)(); });
+          }
+          m_condition.notify_one();
+          return result;
+     }
+
+private:
+     std::condition_variable m_condition;
+     std::mutex m_mutex;
+     std::function<void()> m_notify;
+     bool m_stopped = false;
+     std::queue<std::function<void()> > m_tasks;
+     std::vector<std::thread> m_threads;
+
+};//ThreadPool
+
+}//namespace happah
+
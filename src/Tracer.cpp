@@ -0,0 +1,134 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+#include "Tracer.hpp"
+
+namespace happah {
+
+struct TraceEvent {
+     const char* name;
+     std::int64_t start;//nanoseconds since tracing was enabled
+     std::int64_t duration;//nanoseconds
+     long rss;//peak resident set size in kilobytes
+     std::size_t bytes;
+
+};//TraceEvent
+
+struct TraceBuffer {
+     static constexpr std::size_t MAX_EVENTS = 1 << 20;//NOTE: Long interactive sessions drop later events instead of growing without bound.
+
+     std::vector<TraceEvent> events;
+     hpuint nDropped = 0;
+     long rss = 0;//last peak resident set size that was read
+     std::string thread;
+
+};//TraceBuffer
+
+static std::atomic<bool> g_enabled(false);
+static std::mutex g_mutex;
+static std::vector<std::shared_ptr<TraceBuffer> > g_buffers;
+static std::thread::id g_main;
+static std::chrono::steady_clock::time_point g_start;
+
+//NOTE: A thread registers its buffer when it records its first zone; the registry keeps the buffer alive after the thread has exited.
+static TraceBuffer& get_buffer() {
+     thread_local auto buffer = std::shared_ptr<TraceBuffer>();
+     if(!buffer) {
+          buffer = std::make_shared<TraceBuffer>();
+          buffer->events.reserve(1024);
+          std::lock_guard<std::mutex> lock(g_mutex);
+          buffer->thread = (std::this_thread::get_id() == g_main) ? std::string("main") : "thread " + std::to_string(g_buffers.size());
+          g_buffers.push_back(buffer);
+     }
+     return *buffer;
+}
+
+static void write_string(std::ostream& stream, const std::string& text) {
+     stream << '"';
+     for(auto c : text) {
+          if(c == '"' || c == '\\') stream << '\\';
+          stream << c;
+     }
+     stream << '"';
+}
+
+void enable_tracing() {
+     g_main = std::this_thread::get_id();
+     g_start = std::chrono::steady_clock::now();
+     g_enabled = true;
+}
+
+bool is_tracing() { return g_enabled.load(std::memory_order_relaxed); }
+
+void write_trace(const std::string& path) {
+     std::ofstream stream(path);
+     if(!stream) throw std::runtime_error("Failed to open " + path + '.');
+     std::lock_guard<std::mutex> lock(g_mutex);
+     auto nEvents = std::size_t(0);
+     auto nDropped = hpuint(0);
+     auto first = true;
+     auto separate = [&]() {
+          stream << (first ? "\n" : ",\n");
+          first = false;
+     };
+     stream << std::fixed << std::setprecision(3);//microseconds
+     stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+     for(auto tid = std::size_t(0); tid < g_buffers.size(); ++tid) {
+          auto& buffer = *g_buffers[tid];
+          separate();
+          stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+          write_string(stream, buffer.thread);
+          stream << "}}";
+          for(auto& event : buffer.events) {
+               separate();
+               stream << "{\"name\":";
+               write_string(stream, event.name);
+               stream << ",\"cat\":\"happah\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << double(event.start) * 1e-3 << ",\"dur\":" << double(event.duration) * 1e-3 << ",\"args\":{\"peakRssKiB\":" << event.rss;
+               if(event.bytes) stream << ",\"bytes\":" << event.bytes;
+               stream << "}}";
+          }
+          nEvents += buffer.events.size();
+          nDropped += buffer.nDropped;
+     }
+     stream << "\n]}\n";
+     if(!stream) throw std::runtime_error("Failed to write " + path + '.');
+     std::cout << "INFO: Wrote " << nEvents << " trace events to " << path << '.' << std::endl;
+     if(nDropped) std::cerr << "WARNING: " << nDropped << " trace events were dropped." << std::endl;
+}
+
+TraceZone::TraceZone(const char* name)
+     : m_name(is_tracing() ? name : nullptr) { if(m_name) m_start = std::chrono::steady_clock::now(); }
+
+//NOTE: Reading the peak resident set size is a system call that costs more than the rest of a zone, so short zones reuse the last value of their thread.
+TraceZone::~TraceZone() {
+     if(!m_name) return;
+     auto end = std::chrono::steady_clock::now();
+     auto& buffer = get_buffer();
+     if(buffer.events.size() == TraceBuffer::MAX_EVENTS) {
+          ++buffer.nDropped;
+          return;
+     }
+     if(end - m_start > std::chrono::microseconds(100) || buffer.events.empty()) {
+          auto usage = rusage();
+          getrusage(RUSAGE_SELF, &usage);
+          buffer.rss = usage.ru_maxrss;
+     }
+     auto nanoseconds = [](auto duration) { return std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()); };
+     buffer.events.push_back({ m_name, nanoseconds(m_start - g_start), nanoseconds(end - m_start), buffer.rss, m_bytes });
+}
+
+}//namespace happah
+
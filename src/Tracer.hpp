@@ -0,0 +1,52 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <happah/Happah.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace happah {
+
+//DECLARATIONS
+
+class TraceZone;
+
+//NOTE: Starts recording zones on all threads.  The calling thread is named main in the trace.
+void enable_tracing();
+
+bool is_tracing();
+
+//NOTE: Writes the zones recorded so far as a Chrome trace (chrome://tracing or ui.perfetto.dev).  No other thread may record zones while the trace is written.
+void write_trace(const std::string& path);
+
+//DEFINITIONS
+
+//NOTE: Records the wall time of a scope on the current thread together with the peak resident set size of the process at its end and the number of bytes it uploaded.  The name must outlive the trace; string literals do.  While tracing is disabled, a zone only reads one atomic flag; while it is enabled, it appends one event to a buffer of the thread without locking.
+class TraceZone {
+public:
+     TraceZone(const char* name);
+
+     TraceZone(const TraceZone& zone) = delete;
+
+     ~TraceZone();
+
+     TraceZone& operator=(const TraceZone& zone) = delete;
+
+     void addBytes(std::size_t bytes) { m_bytes += bytes; }
+
+private:
+     std::size_t m_bytes = 0;
+     const char* m_name;//null if tracing is disabled
+     std::chrono::steady_clock::time_point m_start;
+
+};//TraceZone
+
+}//namespace happah
+
@@ -15,275 +15,560 @@
 #include <happah/math/Space.hpp>
 #include <GLFW/glfw3.h>//NOTE: Glad must be included before GLFW.
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
-
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "InputLog.hpp"
+#include "FileWatcher.hpp"
+#include "FrameCapture.hpp"
+#include "MeshFile.hpp"
+#include "MeshPanels.hpp"
+#include "PanelRenderer.hpp"
+#include "Profiler.hpp"
+#include "RenderQueue.hpp"
+#include "Scene.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
 #include "Viewer.hpp"
 
 namespace happah {
 
-Viewer::Viewer(hpuint width, hpuint height, const std::string& title)
-     : m_window(width, height, title) {
+template<class T>
+static std::shared_ptr<T> to_shared(T value) { return std::make_shared<T>(std::move(value)); }
+
+template<class T>
+static bool is_ready(const std::future<T>& future) { return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+//NOTE: The hints only apply to windows that are created after them.  The buffers, vertex arrays and framebuffers are made with direct state access, which needs OpenGL 4.5.
+static std::unique_ptr<Window> make_window(hpuint width, hpuint height, const std::string& title) {
      glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);//TODO: find current version
-     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-     glfwMakeContextCurrent(m_window.getContext());
+     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+     return std::make_unique<Window>(width, height, title);
+}
+
+Viewer::Viewer(hpuint width, hpuint height, const std::string& title)
+     : m_window(make_window(width, height, title)) {
+     glfwMakeContextCurrent(m_window->getContext());
      if(!gladLoadGL()) throw std::runtime_error("Failed to initialize Glad.");
+     if(!GLAD_GL_VERSION_4_5) throw std::runtime_error("The window does not support OpenGL 4.5.");
 }
 
-void Viewer::execute(int argc, char* argv[]) {
-     auto context = m_window.getContext();
-     auto& viewport = m_window.getViewport();
+Viewer::Viewer(hpuint width, hpuint height)
+     : m_context(std::make_unique<OffscreenContext>(width, height)) {}
 
-     auto blue = hpcolor(0.0, 0.0, 1.0, 1.0);
-     auto green = hpcolor(0.0, 1.0, 0.0, 1.0);
-     auto red = hpcolor(1.0, 0.0, 0.0, 1.0);
-     
-     std::cout << "INFO: Importing " << argv[1] << '.' << std::endl;
-
-     auto content = format::off::read(argv[1]);
-     auto mesh = make_triangle_mesh<VertexP3>(content);
-     auto graph = make_triangle_graph(mesh);
-     auto edgeColors = std::vector<hpcolor>(3 * size(mesh), green); //std::vector<hpcolor>(3 * size(mesh), blue);
-     auto triangleColors = std::vector<hpcolor>(3 * size(mesh), blue);
-     auto vertexColors = std::vector<hpcolor>(3 * size(mesh), red); //std::vector<hpcolor>(3 * size(mesh), blue);
-     auto triangles = make_triangle_array(mesh);
-     auto boxes = make_loop_box_spline_mesh(mesh);
-     auto quartic = make_spline_surface(graph);
-     //auto mesh = make_triangle_mesh(quartic, 4);
-     auto quintic = elevate(quartic);
-
-     for(auto e : trim(graph, cut(graph))){
-          edgeColors[e] = red;
-          visit_spokes(make_spokes_enumerator(graph.getEdges(), e), [&](auto e) {
-               static constexpr hpuint o[3] = { 1, 2, 0 };
-               
-               auto f = graph.getEdge(e).opposite;
-               auto t = make_triangle_index(f);
-               auto i = make_edge_offset(f);
-               vertexColors[3 * t + o[i]] = red;
-               vertexColors[e] = red;
-          });
-     }
-     
-     //TODO: only for testing !!!
-     for(int i = 0; i < size(triangleColors); i += 3){
-          triangleColors[i] = red;
-          triangleColors[i+1] = blue;
-          triangleColors[i+2] = green;
-     }
-     
-     std::cout << "INFO: Making shaders." << std::endl;
-
-     load("/happah/illumination.h.glsl", p("shaders/illumination.h.glsl"));
-     load("/happah/paint.h.glsl", p("shaders/paint.h.glsl"));
-     load("/happah/geometry.h.glsl", p("shaders/geometry.h.glsl"));
-
-     auto ed_fr = make_edge_fragment_shader();
-     auto ed_gm = make_geometry_shader(p("shaders/edge.g.glsl"));
-     auto ed_vx = make_edge_vertex_shader();
-     auto hl_fr = make_highlight_lines_fragment_shader();
-     auto lb_te = make_tessellation_evaluation_shader(p("shaders/loop-box-spline.te.glsl"));
-     auto nm_gm = make_geometry_shader(p("shaders/normals.g.glsl"));
-     auto pt_vx = make_patches_vertex_shader();
-     auto pt_gm = make_geometry_shader(p("shaders/patches.g.glsl"));
-     auto pt_fr = make_patches_fragment_shader();
-     auto qp_te = make_tessellation_evaluation_shader(p("shaders/quintic-patch.te.glsl"));
-     auto si_fr = make_sphere_impostor_fragment_shader();
-     auto si_gm = make_sphere_impostor_geometry_shader();
-     auto sm_fr = make_simple_fragment_shader();
-     auto sm_vx = make_simple_vertex_shader();
-     auto tr_fr = make_triangles_fragment_shader();
-     auto tr_gm = make_geometry_shader(p("shaders/triangles.g.glsl"));
-     auto tr_vx = make_triangles_vertex_shader();
-     auto wf_fr = make_wireframe_fragment_shader();
-     auto wf_gm = make_geometry_shader(p("shaders/wireframe.g.glsl"));
-
-     compile(ed_fr);
-     compile(ed_gm);
-     compile(ed_vx);
-     compile(hl_fr);
-     compile(lb_te);
-     compile(nm_gm);
-     compile(pt_vx);
-     compile(pt_gm);
-     compile(pt_fr);
-     compile(qp_te);
-     compile(si_fr);
-     compile(si_gm);
-     compile(sm_fr);
-     compile(sm_vx);
-     compile(tr_fr);
-     compile(tr_gm);
-     compile(tr_vx);
-     compile(wf_fr);
-     compile(wf_gm);
+void Viewer::execute(const Options& options) {
+     if(!options.thumbnails.empty()) return executeThumbnails(options);
+     if(options.paths.size() > 1) return executeScene(options);
 
-     std::cout << "INFO: Making programs." << std::endl;
+     auto& viewport = getViewport();
+     auto notify = [&]() { if(m_window) glfwPostEmptyEvent(); };
 
-     auto lmp = make_program("loop box spline mesh", sm_vx, lb_te, nm_gm, sm_fr);
-     auto ptc = make_program("colored patches mesh", pt_vx, pt_gm, pt_fr);
-     auto qpp = make_program("quintic spline surface", sm_vx, qp_te, hl_fr);
-     auto pcp = make_program("point cloud", sm_vx, si_gm, si_fr);
-     auto tmp = make_program("triangle mesh", sm_vx, nm_gm, sm_fr);
-     auto wfp = make_program("wireframe triangle mesh", sm_vx, wf_gm, wf_fr);
-     auto edp = make_program("edges triangle mesh", ed_vx, ed_gm, ed_fr);
-     auto trp = make_program("triangle colors mesh", tr_vx, tr_gm, tr_fr);
-
-     std::cout << "INFO: Making buffers." << std::endl;
-
-     auto bv0 = make_buffer(mesh.getVertices());
-     auto bv1 = make_buffer(quintic.getControlPoints());
-     auto bv2 = make_buffer(boxes.getControlPoints());
-     auto bv3 = make_buffer(triangles.getVertices());
-     auto bi0 = make_buffer(mesh.getIndices());
-     auto bi1 = make_buffer(std::get<1>(quintic.getPatches()));
-     auto bi2 = make_buffer(boxes.getIndices());
-     auto be3 = make_buffer(edgeColors);
-     auto bc3 = make_buffer(vertexColors);
-     auto bt3 = make_buffer(triangleColors);
-
-     std::cout << "INFO: Making vertex arrays." << std::endl;
-
-     auto edgeColor = make_attribute(2, 4, DataType::FLOAT);
-     auto position = make_attribute(0, 4, DataType::FLOAT);
-     auto vertexColor = make_attribute(1, 4, DataType::FLOAT);
+     std::cout << "INFO: Making shaders." << std::endl;
 
-     auto va0 = make_vertex_array();
+     PanelRenderer renderer(options);
 
-     describe(va0, 0, position);
-     describe(va0, 1, vertexColor);
-     describe(va0, 2, edgeColor);
+     std::cout << "INFO: Importing " << options.paths[0] << '.' << std::endl;
 
-     std::cout << "INFO: Making render contexts." << std::endl;
+     MeshPanels panels(options, renderer, notify);
 
-     auto rc0 = make_render_context(va0, bi0, PatchType::TRIANGLE);
-     auto rc1 = make_render_context(va0, bi1, PatchType::QUINTIC);
-     auto rc2 = make_render_context(va0, bi2, PatchType::LOOP_BOX_SPLINE);
-     auto rc30 = make_render_context(va0, PatchType::TRIANGLE);
-     auto rc31 = make_render_context(va0, PatchType::TRIANGLE);
-     auto rc4 = make_render_context(va0, PatchType::POINT);
+     std::cout << "INFO: Making programs." << std::endl;
 
-     std::cout << "INFO: Setting up scene." << std::endl;
+     panels.require(options.panels);
 
-     auto bandWidth = 1.0;
-     auto beamDirection = Vector3D(0.0, 0.0, 1.0);
-     auto beamOrigin = Point3D(10.0, 0.0, 0.0);
-     auto box = make_axis_aligned_bounding_box(mesh);
-     auto edgeWidth = 0.006; //0.02;//TODO: 0.1 * average height?
-     auto lengths = std::get<1>(box) - std::get<0>(box);
-     auto level0 = std::array<float, 2>({ 50, 50 });
-     auto level1 = std::array<float, 4>({ 30, 30, 30, 30 });
-     auto padding = hpreal(0.1) * lengths;
-     auto radius = 0.05;
+     std::cout << "INFO: Program cache: " << renderer.getProgramCache().getNumberOfHits() << " hits, " << renderer.getProgramCache().getNumberOfMisses() << " misses." << std::endl;
 
      std::cout << "INFO: Rendering scene." << std::endl;
 
-     look_at(viewport, mesh.getVertices());
+     look_at(viewport, panels.getMesh().getVertices());
      glClearColor(1, 1, 1, 1);
+
+     //NOTE: Every drawn frame is captured before the buffers are swapped.  The window cannot be resized while capturing (see main), and its framebuffer may have more pixels than the viewport.
+     auto framebuffer = (m_context) ? m_context->getFramebuffer() : GLuint(0);
+     auto capture = [&]() {
+          if(options.capture.empty()) return std::unique_ptr<FrameCapture>();
+          auto width = int(viewport.getWidth());
+          auto height = int(viewport.getHeight());
+          if(m_window) glfwGetFramebufferSize(m_window->getContext(), &width, &height);
+          return std::make_unique<FrameCapture>(options.capture, hpuint(width), hpuint(height));
+     }();
+     auto captureFrame = [&](Profiler& profiler) {
+          if(!capture) return;
+          profiler.begin("capture");
+          capture->capture(framebuffer);
+          profiler.end();
+     };
+     auto reportCapture = [&]() {
+          if(!capture) return;
+          capture->finish();
+          std::cout << "INFO: Captured " << capture->getNumberOfFrames() << " frames to " << options.capture << "; " << capture->getNumberOfStalls() << " frames waited " << std::chrono::duration<double, std::milli>(capture->getStallTime()).count() << " ms in total for a free buffer." << std::endl;
+     };
+
+     auto& buffers = panels.getBuffers();
+
+     if(options.benchmark) {
+          //NOTE: The camera orbits the scene by dragging horizontally through the center of the viewport so that every run follows the same path.
+          auto x = hpreal(0.5) * viewport.getWidth();
+          auto y = hpreal(0.5) * viewport.getHeight();
+          auto step = hpreal(2 * viewport.getWidth()) / hpreal(options.benchmark);
+          auto orbit = [&](Profiler& profiler, bool capturing) {
+               for(auto i = hpuint(0); i < options.benchmark; ++i) {
+                    viewport.rotate(x, y, x + step, y);
+                    panels.upload();
+                    profiler.beginFrame();
+                    panels.render(profiler, viewport, options.panels);
+                    if(capturing) captureFrame(profiler);
+                    profiler.endFrame();
+               }
+               profiler.finish();
+               profiler.report(std::cout);
+          };
+
+          panels.wait();
+
+          if(capture) {
+               //NOTE: A blocking profiler would wait for every frame and keep the reads of the capture from overlapping with rendering.  The full orbit is drawn twice without blocking, first without and then with the capture, so that the throughputs show what capturing costs.
+               Profiler uncaptured(true, false);
+               Profiler captured(true, false);
+               std::cout << "INFO: Benchmarking " << options.benchmark << " frames at " << viewport.getWidth() << 'x' << viewport.getHeight() << " without capture." << std::endl;
+               orbit(uncaptured, false);
+               std::cout << "INFO: Benchmarking " << options.benchmark << " frames at " << viewport.getWidth() << 'x' << viewport.getHeight() << " with capture." << std::endl;
+               orbit(captured, true);
+               reportCapture();
+               std::cout << "INFO: Capturing changed the throughput from " << std::fixed << std::setprecision(1) << uncaptured.getThroughput() << " to " << captured.getThroughput() << " frames per second." << std::endl;
+          } else {
+               Profiler profiler;
+               std::cout << "INFO: Benchmarking " << options.benchmark << " frames at " << viewport.getWidth() << 'x' << viewport.getHeight() << '.' << std::endl;
+               orbit(profiler, false);
+          }
+          auto& queue = panels.getQueue();
+          std::cout << "INFO: The render queue made " << queue.getNumberOfDrawCalls() << " draw calls and " << queue.getNumberOfStateChanges() << " state changes per frame; sorting the items saved " << queue.getNumberOfSkippedChanges() << " program and buffer changes." << std::endl;
+          if(buffers.streamer) std::cout << "INFO: " << buffers.streamer->getNumberOfVisible() << " of " << buffers.streamer->getNumberOfMeshlets() << " meshlets were visible and " << buffers.streamer->getNumberOfDrawn() << " were drawn from " << buffers.streamer->getNumberOfSlots() << " slots in the last measured frame." << std::endl;
+          auto& culler = panels.getCuller();
+          auto& totals = culler.getTotals();
+          std::cout << "INFO: Culling drew " << totals.nDrawn << " panels and skipped " << totals.nFrustumCulled << " outside the view frustum and " << totals.nOccluded << " occluded ones in " << culler.getNumberOfFrames() << " frames." << std::endl;
+          if(!buffers.lods.empty()) std::cout << "INFO: The mesh, wireframe and point cloud panels drew levels " << panels.getMeshLevel() << ", " << panels.getWireframeLevel() << " and " << panels.getPointLevel() << " of " << buffers.lods.size() << " in the last measured frame." << std::endl;
+          if(options.tolerance > 0) std::cout << "INFO: The adaptive tessellation of " << buffers.nQuinticPatches << " quintic patches generated " << panels.getPrimitives().getCount() << " triangles in the last measured frame." << std::endl;
+          return;
+     }
+
+     auto context = m_window->getContext();
+     auto interval = (options.fps) ? std::chrono::microseconds(1000000 / options.fps) : std::chrono::microseconds(0);
+     auto next = Profiler::Clock::now();
+     auto nPrimitives = GLuint64(0);
+     auto cullStatus = std::string();
+     auto pickStatus = std::string();
+     auto streamStatus = std::string();
+     auto tessellationStatus = std::string();
+     auto replaying = !options.replay.empty();
+     Profiler profiler(replaying);
+
+     m_window->setPanels(options.panels);
+     m_window->setPanelsLocked(options.budget > 0);//NOTE: The budget only covers the mesh panel; the other panels would upload the whole mesh.
+
+     auto setStatus = [&]() {
+          auto status = std::string();
+          for(auto part : { &pickStatus, &cullStatus, &streamStatus, &tessellationStatus }) if(!part->empty()) status += (status.empty() ? "" : ", ") + *part;
+          m_window->setStatus(status);
+     };
+
+     panels.enablePicking();
+
+     //NOTE: The shader files and the mesh file are watched and reloaded when they are saved.  A changed shader is recompiled in place and only the programs that it is linked into are made again.  A changed header is included by any shader, so all shaders are recompiled and all programs are made again.
+     FileWatcher watcher(notify);
+
+     if(!replaying) {
+          watcher.watch(options.paths[0]);
+          for(auto& path : renderer.getShaderPaths()) watcher.watch(path);
+     }
+
+     //NOTE: Unless the continuous mode is requested, the loop sleeps in glfwWaitEvents and only redraws after an event has marked the window dirty.
+     if(!options.record.empty()) m_window->record(options.record);
+     //NOTE: A replay starts after all surfaces are uploaded and redraws every frame so that the frame times of two runs can be compared.
+     if(replaying) {
+          auto log = read_input_log(options.replay);
+          if(std::get<0>(log) != viewport.getWidth() || std::get<1>(log) != viewport.getHeight()) std::cerr << "WARNING: " << options.replay << " was recorded at " << std::get<0>(log) << 'x' << std::get<1>(log) << ", which differs from the window size." << std::endl;
+          panels.wait();
+          std::cout << "INFO: Replaying " << std::get<2>(log).size() << " events from " << options.replay << '.' << std::endl;
+          m_window->replay(std::move(std::get<2>(log)), options.fastReplay);
+     }
+
      while(!glfwWindowShouldClose(context)) {
-          
-          glfwPollEvents();
+          if(options.continuous || replaying || m_window->isDirty()) glfwPollEvents();
+          else glfwWaitEvents();
+          if(replaying) {
+               if(!m_window->isReplaying()) break;
+               m_window->dispatchReplayedEvents();
+          }
+          for(auto& path : watcher.getChanges()) {
+               if(path == options.paths[0]) {
+                    if(!panels.reload()) continue;
+                    pickStatus = panels.getPickStatus();
+                    setStatus();
+                    m_window->setDirty(true);
+               } else if(renderer.reload(path)) m_window->setDirty(true);
+          }
+          panels.require(m_window->getPanels());
+          if(panels.upload()) m_window->setDirty(true);
+          if(panels.isPicking() && (m_window->isHovering() || m_window->isClicked())) {
+               if(panels.pick(viewport, m_window->getCursor(), m_window->getPanels(), m_window->isClicked())) {
+                    pickStatus = panels.getPickStatus();
+                    setStatus();
+                    m_window->setDirty(true);
+               }
+               m_window->resetPicking();
+          }
+          if(!options.continuous && !replaying && !m_window->isDirty()) continue;
+          if(options.fps) {
+               std::this_thread::sleep_until(next);
+               next = std::max(next + interval, Profiler::Clock::now());
+               glfwPollEvents();//NOTE: Events that arrived while sleeping are drawn in this frame.
+               panels.require(m_window->getPanels());
+          }
+          m_window->setDirty(false);
+          profiler.beginFrame();
+          panels.render(profiler, viewport, m_window->getPanels());
+          captureFrame(profiler);
+          profiler.endFrame();
+          glfwSwapBuffers(context);
+          m_window->endFrame();
+          auto& culler = panels.getCuller();
+          if(culler.getCounts().nOccluded && culler.update()) m_window->setDirty(true);//NOTE: A panel that came out from behind another one is drawn without waiting for the next event.
+          auto& counts = culler.getCounts();
+          auto status = (counts.nFrustumCulled || counts.nOccluded) ? std::to_string(counts.nDrawn) + " panels drawn, " + std::to_string(counts.nFrustumCulled) + " outside the view, " + std::to_string(counts.nOccluded) + " occluded" : std::string();
+          if(status != cullStatus) {
+               cullStatus = status;
+               setStatus();
+          }
+          if(options.tolerance > 0 && panels.getPrimitives().getCount() != nPrimitives) {
+               nPrimitives = panels.getPrimitives().getCount();
+               tessellationStatus = std::to_string(buffers.nQuinticPatches) + " quintic patches, " + std::to_string(nPrimitives) + " triangles at " + std::to_string(options.tolerance) + " px";
+               setStatus();
+          }
+          if(buffers.streamer) {
+               auto status = std::to_string(buffers.streamer->getNumberOfResident()) + '/' + std::to_string(buffers.streamer->getNumberOfMeshlets()) + " meshlets resident, " + std::to_string(buffers.streamer->getNumberOfPending()) + " loading";
+               if(status != streamStatus) {
+                    streamStatus = status;
+                    setStatus();
+               }
+          }
+     }
+
+     if(replaying) profiler.report(std::cout);
+     reportCapture();
+}
+
+void Viewer::executeScene(const Options& options) {
+     auto& viewport = getViewport();
+     auto blue = hpcolor(0.0, 0.0, 1.0, 1.0);
+     auto nFiles = hpuint(options.paths.size());
+     auto nThreads = std::max(1u, std::thread::hardware_concurrency());
+     auto start = Profiler::Clock::now();
+
+     std::cout << "INFO: Importing " << nFiles << " files." << std::endl;
+
+     //NOTE: The files are read concurrently; the threads of the machine are split among the files that are read at the same time.
+     using Part = std::tuple<TriangleMesh<VertexP3>, std::uint64_t, decltype(make_axis_aligned_bounding_box(std::declval<TriangleMesh<VertexP3> >()))>;
+     auto parts = std::vector<std::future<Part> >();
+     {
+          auto nWorkers = std::min(nThreads, nFiles);
+          ThreadPool pool(nWorkers);
+          parts.reserve(nFiles);
+          for(auto& path : options.paths) parts.push_back(pool.submit([&, path]() {
+               auto mesh = read_triangle_mesh(path, options.cache, std::max(1u, nThreads / nWorkers));
+               auto hash = make_hash(mesh);
+               auto box = make_axis_aligned_bounding_box(mesh);
+               return Part(std::move(mesh), hash, box);
+          }));
+          for(auto& part : parts) part.wait();
+     }
+
+     //NOTE: Parts with the same content are drawn as instances of one mesh.
+     auto boxes = std::vector<std::tuple<Point3D, Point3D> >();
+     auto meshes = std::vector<Part>();//distinct meshes
+     auto instances = std::vector<std::vector<hpuint> >();//parts per distinct mesh
+     auto hashes = std::unordered_multimap<std::uint64_t, hpuint>();
+     boxes.reserve(nFiles);
+     for(auto i = hpuint(0); i < nFiles; ++i) {
+          auto part = parts[i].get();
+          boxes.emplace_back(std::get<0>(std::get<2>(part)), std::get<1>(std::get<2>(part)));
+          auto candidates = hashes.equal_range(std::get<1>(part));
+          auto match = std::find_if(candidates.first, candidates.second, [&](const auto& candidate) { return is_equal(std::get<0>(meshes[candidate.second]), std::get<0>(part)); });
+          if(match != candidates.second) instances[match->second].push_back(i);
+          else {
+               hashes.emplace(std::get<1>(part), hpuint(meshes.size()));
+               instances.push_back({ i });
+               meshes.push_back(std::move(part));
+          }
+     }
+
+     auto translations = make_scene_layout(boxes);
+     auto corners = std::vector<VertexP3>();
+     for(auto i = hpuint(0); i < nFiles; ++i) {
+          corners.push_back(VertexP3(std::get<0>(boxes[i]) + translations[i]));
+          corners.push_back(VertexP3(std::get<1>(boxes[i]) + translations[i]));
+     }
+
+     Scene scene;
+     for(auto m = std::size_t(0); m < meshes.size(); ++m) {
+          auto modelMatrices = std::vector<glm::mat4>();
+          for(auto i : instances[m]) modelMatrices.push_back(glm::translate(glm::mat4(1.0), translations[i]));
+          scene.add(std::get<0>(meshes[m]), modelMatrices);
+     }
+     meshes.clear();
+
+     std::cout << "INFO: Imported " << nFiles << " files with " << scene.getNumberOfMeshes() << " distinct meshes in " << std::chrono::duration<double>(Profiler::Clock::now() - start).count() << " s." << std::endl;
+
+     look_at(viewport, corners);
+
+     auto va0 = make_vertex_array();
+     RenderQueue queue(va0);
+
+     auto renderScene = [&](Profiler& profiler) {
+          TraceZone zone("frame");
           glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
           glEnable(GL_DEPTH_TEST);
 
-          auto projectionMatrix = make_projection_matrix(viewport);
           auto viewMatrix = make_view_matrix(viewport);
-          auto light = glm::normalize(Point3D(viewMatrix[0]));
-          auto tempDirection = viewMatrix * Vector4D(beamDirection, 0.0);
-          auto tempOrigin = viewMatrix * Point4D(beamOrigin, 1.0);
-
-          activate(va0);
-          
-          activate(qpp, PatchType::QUINTIC);
-          activate(bv1, va0, 0);
-          sm_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(lengths.x + padding.x, 0.0, 0.0)));
-          sm_vx.setProjectionMatrix(projectionMatrix);
-          TessellationControlShader::setInnerTessellationLevel(level0);
-          TessellationControlShader::setOuterTessellationLevel(level1);
-          hl_fr.setBandColor0(red);
-          hl_fr.setBandColor1(green);
-          hl_fr.setBandWidth(bandWidth);
-          hl_fr.setBeam(Point3D(tempOrigin) / tempOrigin.w, glm::normalize(Vector3D(tempDirection)));
-          hl_fr.setLight(light);
-          render(qpp, rc1);
-          
-          activate(tmp);
-          activate(bv0, va0, 0);
-          sm_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(-lengths.x - padding.x, 0.0, 0.0)));
-          sm_vx.setProjectionMatrix(projectionMatrix);
-          sm_fr.setLight(light);
-          sm_fr.setModelColor(blue);
-          render(tmp, rc0);
-
-          activate(bv3, va0, 0);
-          sm_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(-lengths.x - padding.x, -lengths.y - padding.y, 0.0)));
-          sm_fr.setModelColor(red);
-          render(tmp, rc30, size(triangles));
-
-          activate(lmp, PatchType::LOOP_BOX_SPLINE);
-          activate(bv2, va0, 0);
-          sm_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(0.0, -lengths.y - padding.y, 0.0)));
-          sm_vx.setProjectionMatrix(projectionMatrix);
-          sm_fr.setLight(light);
-          sm_fr.setModelColor(blue);
-          render(lmp, rc2);
-
-          activate(pcp);
-          activate(bv0, va0, 0);
-          sm_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(lengths.x + padding.x, -lengths.y - padding.y, 0.0)));
-          sm_vx.setProjectionMatrix(projectionMatrix);
-          si_gm.setProjectionMatrix(projectionMatrix);
-          si_gm.setRadius(radius);
-          si_fr.setLight(light);
-          si_fr.setModelColor(blue);
-          si_fr.setProjectionMatrix(projectionMatrix);
-          si_fr.setRadius(radius);
-          render(pcp, rc4, mesh.getNumberOfVertices());
-          
-          activate(wfp);
-          activate(bv0, va0, 0);
-          sm_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(-lengths.x - padding.x, lengths.y + padding.y, 0.0)));
-          sm_vx.setProjectionMatrix(projectionMatrix);
-          wf_fr.setEdgeWidth(edgeWidth);
-          wf_fr.setEdgeColor(red);
-          wf_fr.setLight(light);
-          wf_fr.setModelColor(blue);
-          render(wfp, rc0);
-          
-          activate(trp);
-          activate(bv3, va0, 0);
-          activate(bt3, va0, 1);
-          tr_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(0.0, lengths.y + padding.y, 0.0)));
-          tr_vx.setProjectionMatrix(projectionMatrix);
-          tr_fr.setLight(light);
-          render(trp, rc31, size(triangles));
-          
-          activate(edp);
-          activate(bv3, va0, 0);
-          activate(bc3, va0, 1);
-          activate(be3, va0, 2);
-          ed_vx.setModelViewMatrix(viewMatrix);
-          ed_vx.setProjectionMatrix(projectionMatrix);
-          ed_fr.setEdgeWidth(edgeWidth);
-          ed_fr.setLight(light);
-          ed_fr.setModelColor(blue);
-          render(edp, rc31, size(triangles));
-          
-          activate(ptc);
-          activate(bv3, va0, 0); //position
-          activate(bt3, va0, 1); //triangle color
-          activate(be3, va0, 2); //edge color
-          activate(bc3, va0, 3); //vertex color
-          pt_vx.setModelViewMatrix(glm::translate(viewMatrix, Vector3D(lengths.x + padding.x, lengths.y + padding.y, 0.0)));
-          pt_vx.setProjectionMatrix(projectionMatrix);
-          pt_fr.setEdgeWidth(edgeWidth);
-          pt_fr.setLight(light);
-          render(ptc, rc31, size(triangles));
-          
+          auto frame = FrameUniforms();
+          frame.projectionMatrix = make_projection_matrix(viewport);
+          frame.viewMatrix = viewMatrix;
+          frame.light = Vector4D(glm::normalize(Point3D(viewMatrix[0])), 0.0);
+          frame.viewportSize = Vector2D(viewport.getWidth(), viewport.getHeight());
+          queue.beginFrame(frame);
+          queue.push({ "scene", nullptr, nullptr, {{}}, [&]() { scene.render(blue); } });
+          queue.submit(profiler);
+     };
+
+     if(options.benchmark) {
+          //NOTE: The camera orbits the scene as in the benchmark of a single file.
+          auto x = hpreal(0.5) * viewport.getWidth();
+          auto y = hpreal(0.5) * viewport.getHeight();
+          auto step = hpreal(2 * viewport.getWidth()) / hpreal(options.benchmark);
+          Profiler profiler;
+
+          std::cout << "INFO: Benchmarking " << options.benchmark << " frames at " << viewport.getWidth() << 'x' << viewport.getHeight() << '.' << std::endl;
+
+          for(auto i = hpuint(0); i < options.benchmark; ++i) {
+               viewport.rotate(x, y, x + step, y);
+               profiler.beginFrame();
+               renderScene(profiler);
+               profiler.endFrame();
+          }
+          profiler.report(std::cout);
+          std::cout << "INFO: The scene draws " << scene.getNumberOfInstances() << " parts with " << scene.getNumberOfMeshes() << " instanced draw calls per frame." << std::endl;
+          return;
+     }
+
+     auto context = m_window->getContext();
+     Profiler profiler(false);
+
+     while(!glfwWindowShouldClose(context)) {
+          if(options.continuous || m_window->isDirty()) glfwPollEvents();
+          else glfwWaitEvents();
+          if(!options.continuous && !m_window->isDirty()) continue;
+          m_window->setDirty(false);
+          renderScene(profiler);
           glfwSwapBuffers(context);
      }
 }
-     
-}//namespace happah
 
+void Viewer::executeThumbnails(const Options& options) {
+     auto& viewport = getViewport();
+     auto nFiles = hpuint(options.paths.size());
+     auto nThreads = std::max(1u, std::thread::hardware_concurrency());
+     auto width = hpuint(viewport.getWidth());
+     auto height = hpuint(viewport.getHeight());
+     auto start = Profiler::Clock::now();
+
+     //NOTE: The panels of colors need a triangle array and the seams of every file and are left out.
+     auto panels = std::vector<Panel>();
+     for(auto panel : { Panel::MESH, Panel::QUINTIC, Panel::LOOP_BOX_SPLINE, Panel::POINT_CLOUD, Panel::WIREFRAME }) if(options.panels[panel]) panels.push_back(panel);
+     if(panels.empty()) throw std::runtime_error("--thumbnails requires one of the panels mesh, quintic, boxes, points and wireframe.");
+     //NOTE: The images are read back asynchronously and written by the threads of the capture while the next panels are drawn.
+     FrameCapture capture(options.thumbnails, width, height);
+
+     std::cout << "INFO: Making shaders." << std::endl;
+
+     PanelRenderer renderer(options);
+
+     std::cout << "INFO: Making programs." << std::endl;
+
+     auto required = Panels(false);
+     for(auto panel : panels) required.setVisible(panel, true);
+     renderer.require(required);
+
+     std::cout << "INFO: Program cache: " << renderer.getProgramCache().getNumberOfHits() << " hits, " << renderer.getProgramCache().getNumberOfMisses() << " misses." << std::endl;
+
+     auto buffers = std::make_unique<PanelBuffers>();
+     auto diagonal = hpreal(0);//of the bounding box of the mesh
+     auto lower = Point3D(0.0);
+     auto upper = Point3D(0.0);
+     RenderQueue queue(renderer.getVertexArray());
+     Profiler profiler(false);
+
+     auto makeBuffer = [&](const auto& data) {
+          TraceZone zone("upload buffer");
+          zone.addBytes(data.size() * sizeof(data[0]));
+          return std::make_unique<Buffer>(make_buffer(data));
+     };
+
+     //NOTE: The camera is turned by a drag through the center of the viewport; as in the benchmark, a drag across twice the width or height of the viewport is a full turn.
+     auto turn = [&](Camera camera) {
+          static const hpreal turns[][2] = { { 0.0, 0.0 }, { 0.5, 0.0 }, { 0.25, 0.0 }, { -0.25, 0.0 }, { 0.0, 0.25 }, { 0.0, -0.25 }, { 0.125, 0.0625 } };//horizontal and vertical fraction of a turn per camera
+          auto& fractions = turns[hpuint(camera)];
+          auto x = hpreal(0.5) * width;
+          auto y = hpreal(0.5) * height;
+          if(fractions[0] != 0 || fractions[1] != 0) viewport.rotate(x, y, x + 2 * fractions[0] * width, y + 2 * fractions[1] * height);
+     };
+
+     //NOTE: The files are read and their surfaces derived on the pool while the files before them are rendered; every file is read by one thread because the threads are already split among the files.  A task returns a function that uploads its result and frames the camera.
+     using Boxes = decltype(make_loop_box_spline_mesh(std::declval<TriangleMesh<VertexP3> >()));
+     using Quintic = decltype(elevate(make_spline_surface(make_triangle_graph(std::declval<TriangleMesh<VertexP3> >()))));
+     ThreadPool pool(nThreads);
+     auto prepare = [&](const std::string& path) {
+          return pool.submit([&, path]() {
+               auto mesh = to_shared(read_triangle_mesh(path, options.cache, 1));
+               auto boxes = std::shared_ptr<Boxes>();
+               auto quintic = std::shared_ptr<Quintic>();
+               if(options.panels[Panel::QUINTIC]) {
+                    auto graph = [&]() {
+                         TraceZone zone("triangle graph");
+                         return make_triangle_graph(*mesh);
+                    }();
+                    auto quartic = [&]() {
+                         TraceZone zone("spline surface");
+                         return make_spline_surface(graph);
+                    }();
+                    TraceZone zone("elevate");
+                    quintic = to_shared(elevate(quartic));
+               }
+               if(options.panels[Panel::LOOP_BOX_SPLINE]) {
+                    TraceZone zone("loop box spline mesh");
+                    boxes = to_shared(make_loop_box_spline_mesh(*mesh));
+               }
+               auto box = make_axis_aligned_bounding_box(*mesh);
+               return std::function<void()>([&, mesh, boxes, quintic, box]() {
+                    auto& vertexArray = renderer.getVertexArray();
+                    buffers = std::make_unique<PanelBuffers>();
+                    buffers->bv0 = makeBuffer(mesh->getVertices());
+                    buffers->bi0 = makeBuffer(mesh->getIndices());
+                    buffers->rc0 = std::make_unique<RenderContext>(make_render_context(vertexArray, *buffers->bi0, PatchType::TRIANGLE));
+                    buffers->nPoints = hpuint(mesh->getNumberOfVertices());
+                    buffers->nTriangles = hpuint(size(*mesh));
+                    if(quintic) {
+                         buffers->bv1 = makeBuffer(quintic->getControlPoints());
+                         buffers->bi1 = makeBuffer(std::get<1>(quintic->getPatches()));
+                         buffers->nQuinticPatches = hpuint(size(std::get<1>(quintic->getPatches())) / 21);
+                         buffers->rc1 = std::make_unique<RenderContext>(make_render_context(vertexArray, *buffers->bi1, PatchType::QUINTIC));
+                    }
+                    if(boxes) {
+                         buffers->bv2 = makeBuffer(boxes->getControlPoints());
+                         buffers->bi2 = makeBuffer(boxes->getIndices());
+                         buffers->nBoxPatches = hpuint(size(boxes->getIndices()) / 12);
+                         buffers->rc2 = std::make_unique<RenderContext>(make_render_context(vertexArray, *buffers->bi2, PatchType::LOOP_BOX_SPLINE));
+                    }
+                    lower = std::get<0>(box);
+                    upper = std::get<1>(box);
+                    diagonal = glm::length(upper - lower);
+                    //NOTE: The rotation of the previous file is discarded so that every file is seen from the same preset.
+                    viewport = Viewport(width, height);
+                    look_at(viewport, mesh->getVertices());
+                    turn(options.camera);
+               });
+          });
+     };
+
+     //NOTE: Every panel draws the model at the origin.
+     auto renderPanel = [&](Panel panel) {
+          TraceZone zone("thumbnail");
+          glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+          glEnable(GL_DEPTH_TEST);
+
+          auto frame = PanelFrame();
+          frame.lower = lower;
+          frame.offsets.fill(Vector3D(0.0));
+          frame.projectionMatrix = make_projection_matrix(viewport);
+          frame.radius = hpreal(0.005) * diagonal;//NOTE: The points are sized relative to the model because the files of a collection come in any scale.
+          frame.upper = upper;
+          frame.viewMatrix = make_view_matrix(viewport);
+          frame.viewportSize = Vector2D(width, height);
+          auto uniforms = FrameUniforms();
+          uniforms.projectionMatrix = frame.projectionMatrix;
+          uniforms.viewMatrix = frame.viewMatrix;
+          uniforms.light = Vector4D(glm::normalize(Point3D(frame.viewMatrix[0])), 0.0);
+          uniforms.viewportSize = frame.viewportSize;
+          auto shown = Panels(false);
+          shown.setVisible(panel, true);
+          queue.beginFrame(uniforms);
+          renderer.push(queue, *buffers, frame, shown);
+          queue.submit(profiler);
+     };
+
+     //NOTE: The thumbnails of path/name.off are written to thumbnails/name.panel.png.
+     auto getPrefix = [&](const std::string& path) {
+          auto begin = path.find_last_of('/');
+          begin = (begin == std::string::npos) ? 0 : begin + 1;
+          auto end = path.find_last_of('.');
+          if(end == std::string::npos || end < begin) end = path.size();
+          return options.thumbnails + '/' + path.substr(begin, end - begin);
+     };
+
+     std::cout << "INFO: Rendering " << panels.size() << " panels of " << nFiles << " files at " << width << 'x' << height << " to " << options.thumbnails << '.' << std::endl;
+
+     glClearColor(1, 1, 1, 1);
+
+     //NOTE: Twice as many files as threads are read ahead so that the pool is busy while a file is rendered.
+     auto framebuffer = m_context->getFramebuffer();
+     auto nAhead = 2 * nThreads;
+     auto nFailed = hpuint(0);
+     auto nImages = hpuint(0);
+     auto next = hpuint(0);
+     auto prepared = std::deque<std::future<std::function<void()> > >();
+     auto waited = Profiler::Clock::duration(0);//until a file was read
+
+     while(next < nFiles && prepared.size() < nAhead) prepared.push_back(prepare(options.paths[next++]));
+     for(auto i = hpuint(0); i < nFiles; ++i) {
+          auto waiting = Profiler::Clock::now();
+          auto upload = std::function<void()>();
+          try {
+               upload = prepared.front().get();
+          } catch(std::exception& e) {
+               std::cerr << "WARNING: Skipping " << options.paths[i] << ": " << e.what() << std::endl;
+               ++nFailed;
+          }
+          waited += Profiler::Clock::now() - waiting;
+          prepared.pop_front();
+          if(next < nFiles) prepared.push_back(prepare(options.paths[next++]));
+          if(!upload) continue;
+
+          upload();
+          auto prefix = getPrefix(options.paths[i]);
+          for(auto panel : panels) {
+               renderPanel(panel);
+               capture.capture(framebuffer, prefix + '.' + to_string(panel) + ".png");
+               ++nImages;
+          }
+     }
+     capture.finish();
+
+     auto seconds = std::chrono::duration<double>(Profiler::Clock::now() - start).count();
+     auto nRendered = nFiles - nFailed;
+     std::cout << "INFO: Rendered " << nImages << " thumbnails of " << nRendered << " files in " << seconds << " s (" << nRendered / seconds << " files per second); the renderer waited " << std::chrono::duration<double>(waited).count() << " s for files to be read." << std::endl;
+     if(capture.getNumberOfStalls()) std::cout << "INFO: " << capture.getNumberOfStalls() << " thumbnails waited " << std::chrono::duration<double, std::milli>(capture.getStallTime()).count() << " ms in total for a free buffer." << std::endl;
+     if(nFailed) std::cerr << "WARNING: " << nFailed << " of " << nFiles << " files could not be read." << std::endl;
+}
+
+}//namespace happah
@@ -9,8 +9,11 @@
 #pragma once
 
 #include <happah/Happah.hpp>
+#include <memory>
 #include <string>
 
+#include "OffscreenContext.hpp"
+#include "Options.hpp"
 #include "Window.hpp"
 
 namespace happah {
@@ -19,10 +22,21 @@ class Viewer {
 public:
      Viewer(hpuint width, hpuint height, const std::string& title);
 
-     void execute(int argc, char* argv[]);
+     Viewer(hpuint width, hpuint height);//offscreen
+
+     void execute(const Options& options);
 
 private:
-     Window m_window;
+     std::unique_ptr<OffscreenContext> m_context;
+     std::unique_ptr<Window> m_window;
+
+     //NOTE: Shows several files side by side with one instanced draw call per distinct mesh instead of the panels of a single file.
+     void executeScene(const Options& options);
+
+     //NOTE: Renders every shown panel of every file offscreen to a PNG file while the next files are read and preprocessed on a pool.
+     void executeThumbnails(const Options& options);
+
+     Viewport& getViewport() { return (m_window) ? m_window->getViewport() : m_context->getViewport(); }
      
 };//Viewer
 
@@ -13,7 +13,7 @@
 namespace happah {
 
 Window::Window(hpuint width, hpuint height, const std::string& title)
-     : m_handle(glfwCreateWindow(width, height, title.c_str(), 0, 0)), m_viewport(width, height) {
+     : m_handle(glfwCreateWindow(width, height, title.c_str(), 0, 0)), m_title(title), m_viewport(width, height) {
      if(m_handle == 0) throw std::runtime_error("Failed to create window.");
      cache()[m_handle] = this;
      glfwSetCursorPosCallback(m_handle, happah::onCursorPosEvent);
@@ -21,6 +21,7 @@ Window::Window(hpuint width, hpuint height, const std::string& title)
      glfwSetKeyCallback(m_handle, happah::onKeyEvent);
      glfwSetMouseButtonCallback(m_handle, happah::onMouseButtonEvent);
      glfwSetScrollCallback(m_handle, happah::onScrollEvent);
+     glfwSetWindowRefreshCallback(m_handle, happah::onWindowRefreshEvent);
      glfwSetWindowSizeCallback(m_handle, happah::onWindowSizeEvent);
 }
 
@@ -29,13 +30,51 @@ Window::~Window() {
      glfwDestroyWindow(m_handle);
 }
 
+void Window::dispatch(const InputEvent& event) {
+     switch(event.type) {
+     case InputEvent::Type::CURSOR_POS:
+          onCursorPosEvent(event.x, event.y);
+          break;
+     case InputEvent::Type::FRAME:
+          break;
+     case InputEvent::Type::KEY:
+          onKeyEvent(event.key, event.code, event.action, event.mods);
+          break;
+     case InputEvent::Type::MOUSE_BUTTON:
+          onMouseButtonEvent(event.key, event.action, event.mods, event.x, event.y);
+          break;
+     case InputEvent::Type::SCROLL:
+          onScrollEvent(event.x, event.y);
+          break;
+     }
+}
+
+void Window::dispatchReplayedEvents() {
+     auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_replayStart).count();
+     while(isReplaying()) {
+          auto& event = m_replayed[m_next];
+          if(!m_fast && event.time > elapsed) break;
+          ++m_next;
+          if(event.type == InputEvent::Type::FRAME) {
+               if(m_fast) break;
+               continue;
+          }
+          auto coalesced = event.type == InputEvent::Type::CURSOR_POS && isReplaying() && m_replayed[m_next].type == InputEvent::Type::CURSOR_POS && (m_fast || m_replayed[m_next].time <= elapsed);
+          if(!coalesced) dispatch(event);
+     }
+}
+
 void Window::onCursorPosEvent(double x, double y) {
      y = m_viewport.getHeight() - y;
-     if(glfwGetMouseButton(m_handle, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
+     m_cursorX = x;
+     m_cursorY = y;
+     if(m_leftPressed) {
           m_viewport.rotate(m_x, m_y, x, y);
+          m_dirty = true;
+          m_dragged = true;
           m_x = x;
           m_y = y;
-     }
+     } else m_hovering = true;
 }
 
 void Window::onKeyEvent(int key, int code, int action, int mods) {
@@ -44,26 +83,69 @@ void Window::onKeyEvent(int key, int code, int action, int mods) {
      case GLFW_KEY_RIGHT_CONTROL:
           m_ctrlPressed = (action != GLFW_RELEASE);
           break;
+     case GLFW_KEY_1:
+     case GLFW_KEY_2:
+     case GLFW_KEY_3:
+     case GLFW_KEY_4:
+     case GLFW_KEY_5:
+     case GLFW_KEY_6:
+     case GLFW_KEY_7:
+     case GLFW_KEY_8:
+     case GLFW_KEY_9:
+          if(action == GLFW_PRESS && !m_panelsLocked) {
+               m_panels.toggle(Panel(key - GLFW_KEY_1));
+               m_dirty = true;
+          }
+          break;
      case GLFW_KEY_UP:
-          if(action == GLFW_PRESS || action == GLFW_REPEAT) m_viewport.translate(Vector2D(0, m_delta));
+          if(action == GLFW_PRESS || action == GLFW_REPEAT) {
+               m_viewport.translate(Vector2D(0, m_delta));
+               m_dirty = true;
+          }
           break;
      case GLFW_KEY_DOWN:
-          if(action == GLFW_PRESS || action == GLFW_REPEAT) m_viewport.translate(Vector2D(0, -m_delta));
+          if(action == GLFW_PRESS || action == GLFW_REPEAT) {
+               m_viewport.translate(Vector2D(0, -m_delta));
+               m_dirty = true;
+          }
           break;
      case GLFW_KEY_LEFT:
-          if(action == GLFW_PRESS || action == GLFW_REPEAT) m_viewport.translate(Vector2D(m_delta, 0));
+          if(action == GLFW_PRESS || action == GLFW_REPEAT) {
+               m_viewport.translate(Vector2D(m_delta, 0));
+               m_dirty = true;
+          }
           break;
      case GLFW_KEY_RIGHT:
-          if(action == GLFW_PRESS || action == GLFW_REPEAT) m_viewport.translate(Vector2D(-m_delta, 0));
+          if(action == GLFW_PRESS || action == GLFW_REPEAT) {
+               m_viewport.translate(Vector2D(-m_delta, 0));
+               m_dirty = true;
+          }
           break;
      };
 }
 
-void Window::onMouseButtonEvent(hpint button, hpint action, hpint mods) {
-     if(button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-          glfwGetCursorPos(m_handle, &m_x, &m_y);
-          m_y = m_viewport.getHeight() - m_y;
+void Window::onInputEvent(const InputEvent& event) {
+     if(isReplaying()) return;
+     if(m_recorder) m_recorder->write(event);
+     dispatch(event);
+}
+
+void Window::onMouseButtonEvent(hpint button, hpint action, hpint mods, double x, double y) {
+     if(button != GLFW_MOUSE_BUTTON_LEFT) return;
+     m_leftPressed = (action == GLFW_PRESS);
+     if(action == GLFW_PRESS) {
+          m_x = x;
+          m_y = m_viewport.getHeight() - y;
+          m_dragged = false;
      }
+     if(action == GLFW_RELEASE && !m_dragged) m_clicked = true;
+}
+
+void Window::replay(std::vector<InputEvent> events, bool fast) {
+     m_fast = fast;
+     m_next = 0;
+     m_replayed = std::move(events);
+     m_replayStart = std::chrono::steady_clock::now();
 }
 
 void Window::onScrollEvent(double xoffset, double yoffset) {
@@ -73,6 +155,7 @@ void Window::onScrollEvent(double xoffset, double yoffset) {
           auto direction = glm::normalize(make_view_direction(m_viewport));
           m_viewport.translate(delta * direction);
      }
+     m_dirty = true;
 }
 
 }//namespace happah
@@ -12,8 +12,14 @@
 #include <happah/graphics/glad.h>
 #include <happah/graphics/Viewport.hpp>
 #include <GLFW/glfw3.h>//NOTE: Glad must be included before GLFW.
+#include <chrono>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "InputLog.hpp"
+#include "Panels.hpp"
 
 namespace happah {
 
@@ -31,6 +37,8 @@ inline void onMouseButtonEvent(GLFWwindow* handle, int button, int action, int m
      
 inline void onScrollEvent(GLFWwindow* handle, double xoffset, double yoffset);
 
+inline void onWindowRefreshEvent(GLFWwindow* handle);
+
 inline void onWindowSizeEvent(GLFWwindow* handle, int width, int height);
 
 //DEFINITIONS
@@ -41,34 +49,99 @@ public:
 
      ~Window();
 
+     //NOTE: Dispatches the replayed events that are due: at the original speed all events up to the time since the replay started, at maximum speed all events up to the next frame event.  Runs of cursor events are coalesced into their last event so that the viewport is rotated once per frame.
+     void dispatchReplayedEvents();
+
+     //NOTE: Marks that a frame was drawn in the recorded log.
+     void endFrame() { if(m_recorder) m_recorder->write(make_frame_event()); }
+
      GLFWwindow* getContext() const { return m_handle; }
 
+     Point2D getCursor() const { return Point2D(m_cursorX, m_cursorY); }//in pixels from the lower left corner
+
+     const Panels& getPanels() const { return m_panels; }
+
      Viewport& getViewport() { return m_viewport; }
 
+     bool isClicked() const { return m_clicked; }//true if the left button was released without dragging since the last call to resetPicking
+
+     bool isDirty() const { return m_dirty; }//true if the frame has to be redrawn
+
+     bool isHovering() const { return m_hovering; }//true if the cursor moved without a button pressed since the last call to resetPicking
+
+     bool isReplaying() const { return m_next < m_replayed.size(); }
+
+     //NOTE: Writes all input events from now on to the given log.
+     void record(const std::string& path) { m_recorder = std::make_unique<InputRecorder>(path, m_viewport.getWidth(), m_viewport.getHeight()); }
+
+     //NOTE: Replaces the input from GLFW by the given events until all of them have been dispatched.
+     void replay(std::vector<InputEvent> events, bool fast);
+
+     void resetPicking() { m_clicked = m_hovering = false; }
+
+     void setDirty(bool dirty) { m_dirty = dirty; }
+
+     void setPanels(const Panels& panels) {
+          m_panels = panels;
+          m_dirty = true;
+     }
+
+     void setPanelsLocked(bool locked) { m_panelsLocked = locked; }//if true, the keys 1 to 9 do not toggle the panels
+
+     void setStatus(const std::string& status) { glfwSetWindowTitle(m_handle, (m_title + " - " + status).c_str()); }//shown in the title bar
+
 private:
      static std::unordered_map<GLFWwindow*, Window*>& cache() {
           static std::unordered_map<GLFWwindow*, Window*> s_windows;
           return s_windows;
      }
 
+     bool m_clicked = false;
      bool m_ctrlPressed = false;
+     double m_cursorX = 0.0;
+     double m_cursorY = 0.0;
      GLFWwindow* m_handle;
      hpreal m_delta = hpreal(0.1);
+     bool m_dirty = true;
+     bool m_dragged = false;
+     bool m_fast = false;//true if the replay runs at maximum speed
+     bool m_hovering = false;
+     bool m_leftPressed = false;
+     std::size_t m_next = 0;//next replayed event
+     Panels m_panels;
+     bool m_panelsLocked = false;
+     std::unique_ptr<InputRecorder> m_recorder;
+     std::vector<InputEvent> m_replayed;
+     std::chrono::steady_clock::time_point m_replayStart;
+     std::string m_title;
      Viewport m_viewport;
      double m_x;//mouse coordinates
      double m_y;
      
+     void dispatch(const InputEvent& event);
+
      void onCursorPosEvent(double x, double y);
 
-     void onFramebufferSizeEvent(hpuint width, hpuint height) { glViewport(0, 0, width, height); }
+     void onFramebufferSizeEvent(hpuint width, hpuint height) {
+          glViewport(0, 0, width, height);
+          m_dirty = true;
+     }
      
      void onKeyEvent(int key, int code, int action, int mods);
 
-     void onMouseButtonEvent(hpint button, hpint action, hpint mods);
+     //NOTE: Events from GLFW are recorded if a recorder is set and ignored during a replay.
+     void onInputEvent(const InputEvent& event);
+
+     void onMouseButtonEvent(hpint button, hpint action, hpint mods, double x, double y);
      
      void onScrollEvent(double xoffset, double yoffset);
 
-     void onWindowSizeEvent(hpuint width, hpuint height) { m_viewport.setSize(width, height); }
+     void onWindowRefreshEvent() { m_dirty = true; }
+
+     void onWindowSizeEvent(hpuint width, hpuint height) {
+          m_viewport.setSize(width, height);
+          m_dirty = true;
+     }
 
      friend void onCursorPosEvent(GLFWwindow* handle, double x, double y);
 
@@ -80,19 +153,27 @@ private:
      
      friend void onScrollEvent(GLFWwindow* handle, double xoffset, double yoffset);
 
+     friend void onWindowRefreshEvent(GLFWwindow* handle);
+
      friend void onWindowSizeEvent(GLFWwindow* handle, int width, int height);
 
 };//Window
 
-inline void onCursorPosEvent(GLFWwindow* handle, double x, double y) { Window::cache()[handle]->onCursorPosEvent(x, y); }
+inline void onCursorPosEvent(GLFWwindow* handle, double x, double y) { Window::cache()[handle]->onInputEvent(make_cursor_pos_event(x, y)); }
 
 inline void onFramebufferSizeEvent(GLFWwindow* handle, int width, int height) { Window::cache()[handle]->onFramebufferSizeEvent(width, height); }
      
-inline void onKeyEvent(GLFWwindow* handle, int key, int code, int action, int mods){ Window::cache()[handle]->onKeyEvent(key, code, action, mods); }
+inline void onKeyEvent(GLFWwindow* handle, int key, int code, int action, int mods){ Window::cache()[handle]->onInputEvent(make_key_event(key, code, action, mods)); }
 
-inline void onMouseButtonEvent(GLFWwindow* handle, int button, int action, int mods) { Window::cache()[handle]->onMouseButtonEvent(button, action, mods); }
+inline void onMouseButtonEvent(GLFWwindow* handle, int button, int action, int mods) {
+     double x, y;
+     glfwGetCursorPos(handle, &x, &y);
+     Window::cache()[handle]->onInputEvent(make_mouse_button_event(button, action, mods, x, y));
+}
      
-inline void onScrollEvent(GLFWwindow* handle, double xoffset, double yoffset){ Window::cache()[handle]->onScrollEvent(xoffset, yoffset); } 
+inline void onScrollEvent(GLFWwindow* handle, double xoffset, double yoffset){ Window::cache()[handle]->onInputEvent(make_scroll_event(xoffset, yoffset)); } 
+
+inline void onWindowRefreshEvent(GLFWwindow* handle) { Window::cache()[handle]->onWindowRefreshEvent(); }
 
 inline void onWindowSizeEvent(GLFWwindow* handle, int width, int height) { Window::cache()[handle]->onWindowSizeEvent(width, height); }
 
@@ -3,18 +3,118 @@
 // Distributed under the Boost Software License, Version 1.0.
 // (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
 
+#include <happah/format.hpp>
+#include <happah/geometry/BezierTriangleMesh.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+#include "MeshFile.hpp"
+#include "Options.hpp"
+#include "QuinticEvaluator.hpp"
+#include "Tracer.hpp"
 #include "Viewer.hpp"
 
+namespace happah {
+
+//NOTE: Tessellates the quintic spline surface of the mesh on the CPU without a context and writes it to an OFF file.  With --repeat, the evaluation is first repeated that many times without and with AVX2, and the median time is reported.
+static void tessellate(const Options& options) {
+     std::cout << "INFO: Importing " << options.paths[0] << '.' << std::endl;
+
+     auto mesh = read_triangle_mesh(options.paths[0], options.cache);
+     auto quintic = [&]() {
+          TraceZone zone("quintic spline surface");
+          return elevate(make_spline_surface(make_triangle_graph(mesh)));
+     }();
+     auto controlPoints = quintic.getControlPoints();
+     auto patches = std::get<1>(quintic.getPatches());
+     auto nPatches = hpuint(patches.size() / 21);
+     auto segments = (options.deviation > 0) ? make_quintic_segments(controlPoints, patches, options.deviation, options.segments) : std::vector<hpuint>(nPatches, options.segments);
+
+     if(options.repetitions) {
+          auto reference = QuinticSamples();
+          for(auto simd : { false, true }) {
+               if(simd && !is_simd_supported()) {
+                    std::cout << "INFO: The processor does not support AVX2." << std::endl;
+                    break;
+               }
+               auto times = std::vector<double>();
+               auto samples = QuinticSamples();
+               for(auto i = hpuint(0); i < options.repetitions; ++i) {
+                    auto start = std::chrono::steady_clock::now();
+                    samples = evaluate_quintic_patches(controlPoints, patches, segments, simd);
+                    times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+               }
+               std::sort(std::begin(times), std::end(times));
+               auto median = times[times.size() / 2];
+               std::cout << "INFO: The " << ((simd) ? "AVX2" : "scalar") << " evaluator took " << median << " ms (min " << times.front() << " ms) for " << samples.positions.size() << " samples of " << nPatches << " patches, " << samples.positions.size() / median / 1000 << " million samples per second." << std::endl;
+               if(!simd) reference = std::move(samples);
+               else {
+                    auto difference = hpreal(0);
+                    for(auto s = std::size_t(0); s < samples.positions.size(); ++s) difference = std::max(difference, glm::length(samples.positions[s] - reference.positions[s]));
+                    std::cout << "INFO: The AVX2 and scalar positions differ by at most " << difference << '.' << std::endl;
+               }
+          }
+     }
+
+     auto samples = evaluate_quintic_patches(controlPoints, patches, segments);
+     auto surface = make_quintic_mesh(samples, patches);
+     write_triangle_mesh(options.tessellation, surface, options.cache);
+     std::cout << "INFO: Wrote " << surface.getVertices().size() << " vertices and " << surface.getIndices().size() / 3 << " triangles of " << nPatches << " quintic patches to " << options.tessellation << '.' << std::endl;
+}
+
+}//namespace happah
+
 int main(int argc, char* argv[]) {
+     auto options = happah::Options();
+
+     try {
+          options = happah::make_options(argc, argv);
+     } catch(std::exception& e) {
+          std::cerr << e.what() << '\n';
+          return 1;
+     }
+
+     if(!options.trace.empty()) happah::enable_tracing();
+
+     if(!options.tessellation.empty()) {
+          try {
+               happah::tessellate(options);
+               if(!options.trace.empty()) happah::write_trace(options.trace);
+          } catch(std::exception& e) {
+               std::cerr << e.what() << '\n';
+               return 1;
+          }
+          return 0;
+     }
+
+     if(options.benchmark || !options.thumbnails.empty()) {
+          try {
+               auto viewer = happah::Viewer(options.width, options.height);
+               viewer.execute(options);
+               if(!options.trace.empty()) happah::write_trace(options.trace);
+          } catch(std::exception& e) {
+               std::cerr << e.what() << '\n';
+               return 1;
+          }
+          return 0;
+     }
+
      // init glfw
      if(!glfwInit()) {
           std::cerr << "Failed to initialize GLFW.\n";
           return 1;
      }
 
+     //NOTE: The frames of a capture all have the size of the framebuffer when the capture starts.
+     if(!options.capture.empty()) glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
      try {
-          auto viewer = happah::Viewer(640, 480, "Happah Viewer");
-          viewer.execute(argc, argv);
+          auto viewer = happah::Viewer(options.width, options.height, "Happah Viewer");
+          viewer.execute(options);
+          if(!options.trace.empty()) happah::write_trace(options.trace);
      } catch(std::exception& e) {
           std::cerr << e.what() << '\n';
           return 1;
@@ -23,4 +123,3 @@ int main(int argc, char* argv[]) {
      glfwTerminate();
      return 0;
 }
-
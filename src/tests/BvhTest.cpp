@@ -0,0 +1,122 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cmath>
+#include <random>
+
+#include "Bvh.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+//NOTE: Two grids of n by n quads at z = 0 and z = 1, each quad split into two triangles.
+static TriangleMesh<VertexP3> make_grids(hpuint n) {
+     auto vertices = std::vector<VertexP3>();
+     auto indices = Indices();
+     for(auto z = hpuint(0); z < 2; ++z) {
+          auto first = hpuint(vertices.size());
+          for(auto y = hpuint(0); y <= n; ++y) for(auto x = hpuint(0); x <= n; ++x) vertices.push_back(VertexP3(Point3D(hpreal(x) / n, hpreal(y) / n, hpreal(z))));
+          for(auto y = hpuint(0); y < n; ++y) for(auto x = hpuint(0); x < n; ++x) {
+               auto v = first + y * (n + 1) + x;
+               indices.insert(std::end(indices), { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 });
+          }
+     }
+     return TriangleMesh<VertexP3>(std::move(vertices), std::move(indices));
+}
+
+//NOTE: Tests every triangle.
+static Hit intersect(const TriangleMesh<VertexP3>& mesh, const Point3D& origin, const Vector3D& direction) {
+     auto hit = Hit();
+     auto& vertices = mesh.getVertices();
+     auto& indices = mesh.getIndices();
+     for(auto t = hpuint(0); t < indices.size() / 3; ++t) {
+          auto& p0 = vertices[indices[3 * t]].position;
+          auto e1 = vertices[indices[3 * t + 1]].position - p0;
+          auto e2 = vertices[indices[3 * t + 2]].position - p0;
+          auto p = glm::cross(direction, e2);
+          auto determinant = glm::dot(e1, p);
+          if(std::abs(determinant) < hpreal(1e-12)) continue;
+          auto s = origin - p0;
+          auto u = glm::dot(s, p) / determinant;
+          auto q = glm::cross(s, e1);
+          auto v = glm::dot(direction, q) / determinant;
+          auto distance = glm::dot(e2, q) / determinant;
+          if(u < 0 || v < 0 || u + v > 1 || distance < 0 || distance >= hit.t) continue;
+          hit.t = distance;
+          hit.triangle = t;
+          hit.u = u;
+          hit.v = v;
+     }
+     return hit;
+}
+
+//NOTE: Rays that pass close to an edge may hit either neighbor, so only the distances are compared.
+static void check_rays(const TriangleMesh<VertexP3>& mesh, const Bvh& bvh, hpreal offset) {
+     auto generator = std::mt19937(7);
+     auto uniform = std::uniform_real_distribution<hpreal>(-0.2, 1.2);
+     for(auto i = 0; i < 2000; ++i) {
+          auto origin = Point3D(uniform(generator), uniform(generator), offset + 3);
+          auto direction = Vector3D(uniform(generator) - hpreal(0.5), uniform(generator) - hpreal(0.5), -2);
+          auto expected = intersect(mesh, origin, direction);
+          auto hit = bvh.intersect(mesh, origin, direction);
+          HAPPAH_CHECK(bool(hit) == bool(expected));
+          if(hit) HAPPAH_CHECK(std::abs(hit.t - expected.t) < hpreal(1e-4));
+     }
+     HAPPAH_CHECK(!bvh.intersect(mesh, Point3D(0.5, 0.5, offset + 3), Vector3D(0, 0, 1)));//NOTE: The mesh is behind the origin.
+}
+
+static void test_intersect() {
+     auto mesh = make_grids(16);
+     auto bvh = make_bvh(mesh);
+     HAPPAH_CHECK(bvh.getNodes().size() > 1);
+     check_rays(mesh, bvh, 0);
+     auto hit = bvh.intersect(mesh, Point3D(0.3, 0.6, 5), Vector3D(0, 0, -1));
+     HAPPAH_CHECK(hit && std::abs(hit.t - 4) < hpreal(1e-5));//NOTE: The upper grid is nearer.
+}
+
+//NOTE: After the vertices moved, the refit hierarchy finds the same hits as the triangles themselves.
+static void test_refit() {
+     auto mesh = make_grids(16);
+     auto bvh = make_bvh(mesh);
+     auto vertices = mesh.getVertices();
+     for(auto& vertex : vertices) vertex.position = Point3D(vertex.position.x, vertex.position.y, vertex.position.z + hpreal(0.1) * std::sin(7 * vertex.position.x) + 2);
+     auto moved = TriangleMesh<VertexP3>(std::move(vertices), mesh.getIndices());
+     bvh.refit(moved);
+     check_rays(moved, bvh, 2);
+}
+
+static void test_pick() {
+     auto mesh = make_grids(1);
+     auto hit = Hit();
+     hit.t = 1;
+     hit.triangle = 1;
+     auto& indices = mesh.getIndices();
+
+     hit.u = 0.9;
+     hit.v = 0.05;
+     auto pick = make_pick(mesh, hit);
+     HAPPAH_CHECK(pick.type == Pick::Type::VERTEX && pick.triangle == 1 && pick.corner == 1 && pick.index == indices[4]);
+
+     hit.u = 0.5;
+     hit.v = 0.45;
+     pick = make_pick(mesh, hit);
+     HAPPAH_CHECK(pick.type == Pick::Type::EDGE && pick.corner == 1 && pick.index == 4);//NOTE: The edge from the second to the third corner is opposite the first corner.
+
+     hit.u = 0.3;
+     hit.v = 0.3;
+     pick = make_pick(mesh, hit);
+     HAPPAH_CHECK(pick.type == Pick::Type::TRIANGLE && pick.index == 1);
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "intersect", happah::test_intersect },
+          { "refit", happah::test_refit },
+          { "pick", happah::test_pick }
+     });
+}
+
@@ -0,0 +1,54 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "CompactColors.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+static const auto blue = hpcolor(0.0, 0.0, 1.0, 1.0);
+static const auto green = hpcolor(0.0, 1.0, 0.0, 1.0);
+static const auto red = hpcolor(1.0, 0.0, 0.0, 1.0);
+
+static void test_palette() {
+     auto palette = Palette({ blue, green, red });
+     HAPPAH_CHECK(palette.getColors().size() == 3);
+     HAPPAH_CHECK(palette.getIndex(blue) == 0 && palette.getIndex(green) == 1 && palette.getIndex(red) == 2);
+     HAPPAH_CHECK_THROWS(palette.getIndex(hpcolor(1.0, 1.0, 0.0, 1.0)));
+}
+
+//NOTE: The palette index of corner i of a triangle is in byte i of its word.
+static void test_pack() {
+     auto palette = Palette({ blue, green, red });
+     auto words = make_compact_colors(palette, { red, blue, green, green, green, blue });
+     HAPPAH_CHECK(words.size() == 2);
+     HAPPAH_CHECK(words[0] == (2u | (0u << 8) | (1u << 16)));
+     HAPPAH_CHECK(words[1] == (1u | (1u << 8) | (0u << 16)));
+     HAPPAH_CHECK(make_compact_colors(palette, {}).empty());
+     HAPPAH_CHECK_THROWS(make_compact_colors(palette, { blue, blue, hpcolor(0.5, 0.5, 0.5, 1.0) }));
+}
+
+//NOTE: A word holds the same indices as the palette lookups of its three corners.
+static void test_unpack() {
+     auto palette = Palette({ blue, green, red });
+     auto choices = std::vector<hpcolor>({ blue, green, red });
+     auto colors = std::vector<hpcolor>();
+     for(auto c = hpuint(0); c < 300; ++c) colors.push_back(choices[(c * c + c / 3) % 3]);
+     auto words = make_compact_colors(palette, colors);
+     HAPPAH_CHECK(words.size() == colors.size() / 3);
+     for(auto t = std::size_t(0); t < words.size(); ++t) for(auto i = 0; i < 3; ++i) HAPPAH_CHECK(((words[t] >> (8 * i)) & 0xff) == palette.getIndex(colors[3 * t + i]));
+     for(auto word : words) HAPPAH_CHECK((word >> 24) == 0);
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "palette", happah::test_palette },
+          { "pack", happah::test_pack },
+          { "unpack", happah::test_unpack }
+     });
+}
+
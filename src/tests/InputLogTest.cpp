@@ -0,0 +1,63 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <fstream>
+
+#include "InputLog.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+static void write_text(const std::string& path, const std::string& text) {
+     std::ofstream stream(path);
+     stream << text;
+}
+
+static bool is_same(const InputEvent& event0, const InputEvent& event1) { return event0.type == event1.type && event0.key == event1.key && event0.code == event1.code && event0.action == event1.action && event0.mods == event1.mods && event0.x == event1.x && event0.y == event1.y; }
+
+//NOTE: The events are read back exactly, including positions that have no short decimal representation, with the times at which they were written.
+static void test_write_read() {
+     TemporaryFile file("test-input-log.txt");
+     auto events = std::vector<InputEvent>{
+          make_cursor_pos_event(0.1, 1.0 / 3.0),
+          make_mouse_button_event(0, 1, 2, 12.5, -7.25),
+          make_key_event(65, 38, 1, 4),
+          make_scroll_event(0.0, -1.5),
+          make_frame_event()
+     };
+     {
+          auto recorder = InputRecorder(file.getPath(), 640, 480);
+          for(auto& event : events) recorder.write(event);
+     }
+     auto log = read_input_log(file.getPath());
+     HAPPAH_CHECK(std::get<0>(log) == 640 && std::get<1>(log) == 480);
+     auto& read = std::get<2>(log);
+     HAPPAH_CHECK(read.size() == events.size());
+     for(auto i = std::size_t(0); i < read.size() && i < events.size(); ++i) {
+          HAPPAH_CHECK(is_same(read[i], events[i]));
+          HAPPAH_CHECK(read[i].time >= 0.0 && (i == 0 || read[i].time >= read[i - 1].time));
+     }
+}
+
+static void test_errors() {
+     HAPPAH_CHECK_THROWS(read_input_log("test-input-log-missing.txt"));
+     TemporaryFile file("test-input-log-errors.txt");
+     for(auto text : { "", "happah-mesh 1 640 480\n", "happah-input 0 640 480\n", "happah-input 1 640 480\n0 7 0 0 0 0 0 0\n", "happah-input 1 640 480\n0 1 0 0\n" }) {
+          write_text(file.getPath(), text);
+          HAPPAH_CHECK_THROWS(read_input_log(file.getPath()));
+     }
+     write_text(file.getPath(), "happah-input 1 640 480\n\n0.5 1 0 0 0 0 0 0\n");
+     HAPPAH_CHECK(std::get<2>(read_input_log(file.getPath())).size() == 1);//NOTE: Empty lines are skipped.
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "write and read", happah::test_write_read },
+          { "errors", happah::test_errors }
+     });
+}
+
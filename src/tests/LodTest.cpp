@@ -0,0 +1,108 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include "Lod.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+//NOTE: A closed torus of n by m quads, each split into two triangles.
+static TriangleMesh<VertexP3> make_torus(hpuint n, hpuint m) {
+     auto vertices = std::vector<VertexP3>();
+     auto indices = Indices();
+     auto pi = hpreal(3.14159265358979);
+     for(auto i = hpuint(0); i < n; ++i) for(auto j = hpuint(0); j < m; ++j) {
+          auto a = 2 * pi * i / n;
+          auto b = 2 * pi * j / m;
+          auto r = 2 + std::cos(b);
+          vertices.push_back(VertexP3(Point3D(r * std::cos(a), r * std::sin(a), std::sin(b))));
+     }
+     for(auto i = hpuint(0); i < n; ++i) for(auto j = hpuint(0); j < m; ++j) {
+          auto v0 = i * m + j;
+          auto v1 = ((i + 1) % n) * m + j;
+          auto v2 = ((i + 1) % n) * m + (j + 1) % m;
+          auto v3 = i * m + (j + 1) % m;
+          indices.insert(std::end(indices), { v0, v1, v2, v0, v2, v3 });
+     }
+     return TriangleMesh<VertexP3>(std::move(vertices), std::move(indices));
+}
+
+//NOTE: Every index is a vertex, no triangle is degenerate, and every edge is shared by exactly two triangles in opposite directions.
+static void check_closed(const TriangleMesh<VertexP3>& mesh) {
+     auto& indices = mesh.getIndices();
+     auto nVertices = mesh.getVertices().size();
+     auto edges = std::map<std::pair<hpuint, hpuint>, hpuint>();
+     HAPPAH_CHECK(indices.size() % 3 == 0);
+     for(auto i = std::size_t(0); i < indices.size(); i += 3) {
+          for(auto k = 0; k < 3; ++k) {
+               auto v = indices[i + k];
+               auto w = indices[i + (k + 1) % 3];
+               HAPPAH_CHECK(v < nVertices && v != w);
+               ++edges[std::make_pair(v, w)];
+          }
+     }
+     for(auto& edge : edges) HAPPAH_CHECK(edge.second == 1 && edges.count(std::make_pair(edge.first.second, edge.first.first)) == 1);
+}
+
+static void test_simplify() {
+     auto mesh = make_torus(64, 32);
+     check_closed(mesh);
+     for(auto nTriangles : { hpuint(1024), hpuint(256), hpuint(64) }) {
+          auto simplified = simplify(mesh, nTriangles);
+          auto n = simplified.getIndices().size() / 3;
+          HAPPAH_CHECK(n <= nTriangles && 2 * n > nTriangles);
+          check_closed(simplified);
+     }
+     HAPPAH_CHECK(simplify(mesh, 4096).getIndices().size() == mesh.getIndices().size());//NOTE: Nothing is collapsed if the target is already met.
+}
+
+static void test_lod_levels() {
+     auto mesh = make_torus(128, 64);
+     auto levels = make_lod_levels(mesh, 256, 8);
+     HAPPAH_CHECK(levels.size() >= 3);
+     auto nTriangles = mesh.getIndices().size() / 3;
+     auto nPoints = mesh.getVertices().size();
+     auto spacing = hpreal(0);
+     for(auto& level : levels) {
+          auto n = level.mesh.getIndices().size() / 3;
+          HAPPAH_CHECK(n <= nTriangles / 4 && n >= 256 / 4);
+          HAPPAH_CHECK(!level.points.empty() && level.points.size() < nPoints);
+          HAPPAH_CHECK(level.spacing > spacing);
+          check_closed(level.mesh);
+          nTriangles = n;
+          nPoints = level.points.size();
+          spacing = level.spacing;
+     }
+     HAPPAH_CHECK(make_lod_levels(mesh, mesh.getIndices().size()).empty());//NOTE: The mesh is already coarse enough.
+}
+
+static void test_point_clusters() {
+     auto points = std::vector<VertexP3>();
+     points.push_back(VertexP3(Point3D(0.1, 0.1, 0.1)));
+     points.push_back(VertexP3(Point3D(0.3, 0.5, 0.7)));
+     points.push_back(VertexP3(Point3D(1.5, 0.5, 0.5)));
+     points.push_back(VertexP3(Point3D(-0.5, 0.5, 0.5)));
+     auto clusters = make_point_clusters(points, 1);
+     HAPPAH_CHECK(clusters.size() == 3);
+     auto found = 0;
+     for(auto& cluster : clusters) if(glm::length(cluster.position - Point3D(0.2, 0.3, 0.4)) < hpreal(1e-5)) ++found;
+     HAPPAH_CHECK(found == 1);
+     HAPPAH_CHECK(make_point_clusters(points, 4).size() == 2);//NOTE: The negative point lies in the cell below zero.
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "simplify", happah::test_simplify },
+          { "lod levels", happah::test_lod_levels },
+          { "point clusters", happah::test_point_clusters }
+     });
+}
+
@@ -0,0 +1,97 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "MeshFile.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+static void write_text(const std::string& path, const std::string& text) {
+     std::ofstream stream(path);
+     stream << text;
+}
+
+static bool is_same(hpreal a, hpreal b) { return a == b || (std::isnan(a) && std::isnan(b)); }
+
+static bool is_same(const TriangleMesh<VertexP3>& mesh0, const TriangleMesh<VertexP3>& mesh1) {
+     auto& vertices0 = mesh0.getVertices();
+     auto& vertices1 = mesh1.getVertices();
+     if(vertices0.size() != vertices1.size() || mesh0.getIndices() != mesh1.getIndices()) return false;
+     for(auto i = std::size_t(0); i < vertices0.size(); ++i) for(auto k = 0; k < 3; ++k) if(!is_same(vertices0[i].position[k], vertices1[i].position[k])) return false;
+     return true;
+}
+
+static void test_parse() {
+     TemporaryFile file("test-mesh-file-parse.off");
+     write_text(file.getPath(), "# comment\nOFF\n4 2 0\n\n0.1 -2.5e-3 1e10\ninf -nan 3\n0.30000001192092896 7 +8\n1 2 3 # comment\n3 0 1 2\n4 0 2 3 1");
+     auto mesh = read_triangle_mesh(file.getPath(), false, 2);
+     auto& vertices = mesh.getVertices();
+     HAPPAH_CHECK(vertices.size() == 4);
+     HAPPAH_CHECK(vertices[0].position.x == hpreal(0.1) && vertices[0].position.y == hpreal(-2.5e-3) && vertices[0].position.z == hpreal(1e10));
+     HAPPAH_CHECK(vertices[1].position.x == std::numeric_limits<hpreal>::infinity() && std::isnan(vertices[1].position.y));
+     HAPPAH_CHECK(vertices[2].position.x == hpreal(0.30000001192092896) && vertices[2].position.z == hpreal(8));
+     HAPPAH_CHECK(mesh.getIndices() == Indices({ 0, 1, 2, 0, 2, 3, 0, 3, 1 }));//NOTE: The quad is split into a fan.
+}
+
+static void test_errors() {
+     TemporaryFile file("test-mesh-file-errors.off");
+     for(auto text : { "PLY\n", "OFF\n3 1 0\n0 0 0\n1 0 0\n", "OFF\n3 1 0\n0 0 0\n1 0 0\n0 1 0\n3 0 1 3\n", "OFF\n3 1 0\n0 0 0\n1 x 0\n0 1 0\n3 0 1 2\n", "OFF\n3 1 0\n0 0 0\n1 0 0\n0 1 0\n2 0 1\n" }) {
+          write_text(file.getPath(), text);
+          HAPPAH_CHECK_THROWS(read_triangle_mesh(file.getPath(), false));
+     }
+     HAPPAH_CHECK_THROWS(read_triangle_mesh("test-mesh-file-missing.off", false));
+}
+
+//NOTE: The writer prints enough digits that every finite position is read back exactly.
+static void test_write_read() {
+     TemporaryFile file("test-mesh-file-round-trip.off");
+     auto vertices = std::vector<VertexP3>({ VertexP3(Point3D(0.1, 1.0 / 3.0, -7e-20)), VertexP3(Point3D(1e30, -0.0, 2.0)), VertexP3(Point3D(std::nextafter(hpreal(1), hpreal(2)), 5.0, 6.0)) });
+     auto mesh = TriangleMesh<VertexP3>(vertices, Indices({ 0, 1, 2 }));
+     write_triangle_mesh(file.getPath(), mesh, false);
+     HAPPAH_CHECK(is_same(read_triangle_mesh(file.getPath(), false), mesh));
+}
+
+//NOTE: The first read writes the cache and the second one reads it; a changed file makes the cache stale.
+static void test_cache() {
+     TemporaryFile file("test-mesh-file-cache.off");
+     write_text(file.getPath(), "OFF\n4 2 0\n0 0 0\n1 0 0\n0 1 0\n0 0 1\n3 0 1 2\n3 0 2 3\n");
+     auto parsed = read_triangle_mesh(file.getPath(), true);
+     HAPPAH_CHECK(std::ifstream(file.getPath() + ".cache").good());
+     HAPPAH_CHECK(is_same(read_triangle_mesh(file.getPath(), true), parsed));
+     write_text(file.getPath(), "OFF\n3 1 0\n0 0 0\n2 0 0\n0 2 0\n3 0 1 2\n");
+     auto changed = read_triangle_mesh(file.getPath(), true);
+     HAPPAH_CHECK(changed.getVertices().size() == 3 && changed.getVertices()[1].position.x == hpreal(2));
+}
+
+//NOTE: Changes at most gap vertices after the end of a range extend it.
+static void test_changed_ranges() {
+     auto vertices0 = std::vector<VertexP3>(200, VertexP3(Point3D(0, 0, 0)));
+     auto vertices1 = vertices0;
+     HAPPAH_CHECK(make_changed_ranges(vertices0, vertices1).empty());
+     for(auto i : { 3, 4, 10, 100, 199 }) vertices1[i].position.y = 1;
+     auto expected = std::vector<std::pair<hpuint, hpuint> >{ { 3, 5 }, { 10, 11 }, { 100, 101 }, { 199, 200 } };
+     HAPPAH_CHECK(make_changed_ranges(vertices0, vertices1, 4) == expected);
+     expected = { { 3, 11 }, { 100, 101 }, { 199, 200 } };
+     HAPPAH_CHECK(make_changed_ranges(vertices0, vertices1, 8) == expected);
+     expected = { { 3, 200 } };
+     HAPPAH_CHECK(make_changed_ranges(vertices0, vertices1, 100) == expected);
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "parse", happah::test_parse },
+          { "errors", happah::test_errors },
+          { "write and read", happah::test_write_read },
+          { "cache", happah::test_cache },
+          { "changed ranges", happah::test_changed_ranges }
+     });
+}
+
@@ -0,0 +1,87 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <fstream>
+
+#include "Options.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+static Options parse(std::vector<std::string> arguments) {
+     arguments.insert(std::begin(arguments), "happah");
+     auto argv = std::vector<char*>();
+     for(auto& argument : arguments) argv.push_back(&argument[0]);
+     argv.push_back(nullptr);
+     return make_options(int(arguments.size()), argv.data());
+}
+
+static void test_values() {
+     auto options = parse({ "a.off", "--benchmark", "100", "--size=800x600", "--show", "mesh,wireframe", "--tolerance", "2.5", "--no-cache" });
+     HAPPAH_CHECK(options.paths == std::vector<std::string>{ "a.off" });
+     HAPPAH_CHECK(options.benchmark == 100 && options.width == 800 && options.height == 600 && !options.cache);
+     HAPPAH_CHECK(options.panels[Panel::MESH] && options.panels[Panel::WIREFRAME] && !options.panels[Panel::QUINTIC]);
+     HAPPAH_CHECK(options.tolerance == hpreal(2.5));
+
+     options = parse({ "a.off", "--tessellate", "b.off", "--segments", "3", "--repeat", "5" });
+     HAPPAH_CHECK(options.tessellation == "b.off" && options.segments == 3 && options.repetitions == 5);
+
+     TemporaryFile file("test-options-list.txt");
+     std::ofstream(file.getPath()) << "b.off\n\nc.off\n";
+     options = parse({ "a.off", "--list", file.getPath(), "--thumbnails", "t", "--camera", "iso" });
+     HAPPAH_CHECK((options.paths == std::vector<std::string>{ "a.off", "b.off", "c.off" }) && options.camera == Camera::ISO);
+}
+
+static void test_value_errors() {
+     for(auto arguments : std::vector<std::vector<std::string> >{
+          {},
+          { "a.off", "--unknown" },
+          { "a.off", "--benchmark" },
+          { "a.off", "--benchmark", "0" },
+          { "a.off", "--benchmark", "10x" },
+          { "a.off", "--size", "640" },
+          { "a.off", "--size", "640x" },
+          { "a.off", "--tolerance", "-1" },
+          { "a.off", "--tessellate", "b.off", "--deviation", "x" },
+          { "a.off", "--show", "nothing" },
+          { "a.off", "--thumbnails", "t", "--camera", "below" },
+          { "a.off", "--list", "test-options-missing.txt" }
+     }) HAPPAH_CHECK_THROWS(parse(arguments));
+}
+
+//NOTE: Options that would be ignored in the mode that the other options select are rejected.
+static void test_combination_errors() {
+     for(auto arguments : std::vector<std::vector<std::string> >{
+          { "a.off", "--record", "r.log", "--replay", "r.log" },
+          { "a.off", "--fast-replay" },
+          { "a.off", "--benchmark", "10", "--record", "r.log" },
+          { "a.off", "--benchmark", "10", "--replay", "r.log" },
+          { "a.off", "b.off", "--budget", "10", "--show=mesh" },
+          { "a.off", "--budget", "10" },
+          { "a.off", "b.off", "--compact" },
+          { "a.off", "b.off", "--show=mesh" },
+          { "a.off", "b.off", "--fps", "30" },
+          { "a.off", "--tessellate", "b.off", "--benchmark", "10" },
+          { "a.off", "--repeat", "5" },
+          { "a.off", "--tessellate", "b.off", "--capture", "c.rgb" },
+          { "a.off", "--deviation", "0.1" },
+          { "a.off", "--segments", "3" },
+          { "a.off", "--camera", "iso" },
+          { "a.off", "--thumbnails", "t", "--benchmark", "10" }
+     }) HAPPAH_CHECK_THROWS(parse(arguments));
+     parse({ "a.off", "b.off", "--show=mesh", "--thumbnails", "t" });
+     parse({ "a.off", "--budget", "10", "--show=mesh" });
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "values", happah::test_values },
+          { "value errors", happah::test_value_errors },
+          { "combination errors", happah::test_combination_errors }
+     });
+}
+
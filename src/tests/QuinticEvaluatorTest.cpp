@@ -0,0 +1,93 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <tuple>
+#include <utility>
+
+#include "QuinticEvaluator.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+//NOTE: A closed surface of eight quintic patches over the faces of an octahedron whose control points are pushed towards the unit sphere.  Control points on a shared edge are shared, so neighboring patches meet along their edges.
+static std::tuple<std::vector<Point3D>, Indices> make_octahedron() {
+     auto corners = std::vector<Point3D>{ Point3D(1, 0, 0), Point3D(-1, 0, 0), Point3D(0, 1, 0), Point3D(0, -1, 0), Point3D(0, 0, 1), Point3D(0, 0, -1) };
+     auto faces = std::vector<hpuint>{ 0, 2, 4, 2, 1, 4, 1, 3, 4, 3, 0, 4, 2, 0, 5, 1, 2, 5, 3, 1, 5, 0, 3, 5 };
+     auto controlPoints = std::vector<Point3D>();
+     auto patches = Indices();
+     auto shared = std::map<std::tuple<hpreal, hpreal, hpreal>, hpuint>();
+     for(auto f = std::size_t(0); f < faces.size(); f += 3) {
+          auto& a = corners[faces[f]];
+          auto& b = corners[faces[f + 1]];
+          auto& c = corners[faces[f + 2]];
+          for(auto row = 0; row <= 5; ++row) for(auto column = 0; row + column <= 5; ++column) {
+               auto point = hpreal(5 - row - column) * a + hpreal(column) * b + hpreal(row) * c;
+               point = point / (hpreal(0.5) * glm::length(point) + hpreal(2.5));
+               auto key = std::make_tuple(point.x, point.y, point.z);
+               auto i = shared.find(key);
+               if(i == std::end(shared)) {
+                    i = shared.emplace(key, hpuint(controlPoints.size())).first;
+                    controlPoints.push_back(point);
+               }
+               patches.push_back(i->second);
+          }
+     }
+     return std::make_tuple(std::move(controlPoints), std::move(patches));
+}
+
+static void test_simd() {
+     if(!is_simd_supported()) {
+          std::cout << "INFO: Skipped the comparison with the AVX2 evaluator, which the processor does not support." << std::endl;
+          return;
+     }
+     auto surface = make_octahedron();
+     auto& controlPoints = std::get<0>(surface);
+     auto& patches = std::get<1>(surface);
+     auto segments = std::vector<hpuint>{ 1, 2, 3, 5, 7, 8, 13, 16 };//NOTE: Grids whose samples are not a multiple of eight exercise the remainder of the vectorized loop.
+     auto scalar = evaluate_quintic_patches(controlPoints, patches, segments, false, 2);
+     auto simd = evaluate_quintic_patches(controlPoints, patches, segments, true, 2);
+     HAPPAH_CHECK(scalar.offsets == simd.offsets && scalar.segments == simd.segments && scalar.edges == simd.edges);
+     HAPPAH_CHECK(scalar.positions.size() == simd.positions.size() && scalar.normals.size() == simd.normals.size());
+     for(auto i = std::size_t(0); i < scalar.positions.size() && i < simd.positions.size(); ++i) HAPPAH_CHECK(glm::length(scalar.positions[i] - simd.positions[i]) < hpreal(1e-5));
+     for(auto i = std::size_t(0); i < scalar.normals.size() && i < simd.normals.size(); ++i) HAPPAH_CHECK(glm::length(scalar.normals[i] - simd.normals[i]) < hpreal(1e-4));
+}
+
+//NOTE: Every edge of the tessellation of the closed surface is shared by exactly two triangles in opposite directions, also where patches with different segments meet.
+static void test_watertight() {
+     auto surface = make_octahedron();
+     auto& controlPoints = std::get<0>(surface);
+     auto& patches = std::get<1>(surface);
+     HAPPAH_CHECK(controlPoints.size() == 6 + 12 * 4 + 8 * 6);//NOTE: Corners, inner points of the edges and inner points of the patches.
+     for(auto segments : { std::vector<hpuint>(8, 1), std::vector<hpuint>(8, 6), std::vector<hpuint>{ 1, 2, 3, 5, 7, 8, 13, 16 } }) {
+          auto mesh = make_quintic_mesh(evaluate_quintic_patches(controlPoints, patches, segments, false, 2), patches);
+          auto& indices = mesh.getIndices();
+          auto nVertices = mesh.getVertices().size();
+          auto edges = std::map<std::pair<hpuint, hpuint>, hpuint>();
+          HAPPAH_CHECK(indices.size() % 3 == 0 && !indices.empty());
+          for(auto i = std::size_t(0); i < indices.size(); i += 3) {
+               for(auto k = 0; k < 3; ++k) {
+                    auto v = indices[i + k];
+                    auto w = indices[i + (k + 1) % 3];
+                    HAPPAH_CHECK(v < nVertices && v != w);
+                    ++edges[std::make_pair(v, w)];
+               }
+          }
+          for(auto& edge : edges) HAPPAH_CHECK(edge.second == 1 && edges.count(std::make_pair(edge.first.second, edge.first.first)) == 1);
+          HAPPAH_CHECK(nVertices + indices.size() / 3 - edges.size() / 2 == 2);//NOTE: The Euler characteristic of a sphere.
+     }
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "simd", happah::test_simd },
+          { "watertight", happah::test_watertight }
+     });
+}
+
@@ -0,0 +1,46 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cmath>
+
+#include "Scene.hpp"
+#include "Test.hpp"
+
+namespace happah {
+
+static bool is_near(hpreal a, hpreal b) { return std::abs(a - b) < hpreal(1e-5); }
+
+static void test_layout() {
+     HAPPAH_CHECK(make_scene_layout({}).empty());
+
+     auto boxes = std::vector<std::tuple<Point3D, Point3D> >();
+     for(auto i = 0; i < 5; ++i) boxes.emplace_back(Point3D(i, -i, 1), Point3D(2 * i + 1, i + 1, 3));
+     auto translations = make_scene_layout(boxes);
+     HAPPAH_CHECK(translations.size() == boxes.size());
+
+     auto placed = std::vector<std::tuple<Point3D, Point3D> >();
+     for(auto i = std::size_t(0); i < boxes.size(); ++i) placed.emplace_back(std::get<0>(boxes[i]) + translations[i], std::get<1>(boxes[i]) + translations[i]);
+
+     //NOTE: Five parts are placed in rows of three, the first part at the origin; the parts are centered in z.
+     HAPPAH_CHECK(is_near(std::get<0>(placed[0]).x, 0) && is_near(std::get<0>(placed[3]).x, 0));
+     for(auto& box : placed) HAPPAH_CHECK(is_near(std::get<0>(box).z + std::get<1>(box).z, 0));
+
+     //NOTE: Parts in a row are left to right and share a vertical center; the second row is below the first.
+     for(auto i : { 1, 2, 4 }) {
+          HAPPAH_CHECK(std::get<0>(placed[i]).x > std::get<1>(placed[i - 1]).x);
+          HAPPAH_CHECK(is_near(std::get<0>(placed[i]).y + std::get<1>(placed[i]).y, std::get<0>(placed[i - 1]).y + std::get<1>(placed[i - 1]).y));
+     }
+     for(auto i = 0; i < 3; ++i) for(auto j = 3; j < 5; ++j) HAPPAH_CHECK(std::get<1>(placed[j]).y < std::get<0>(placed[i]).y);
+}
+
+}//namespace happah
+
+int main() {
+     return happah::run_tests({
+          { "layout", happah::test_layout }
+     });
+}
+
@@ -0,0 +1,88 @@
+// Copyright 2017
+//   Pawel Herman - Karlsruhe Institute of Technology - pherman@ira.uka.de
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+//NOTE: Fails the running test with the file, line and text of the condition.
+#define HAPPAH_CHECK(condition) ::happah::check((condition), #condition, __FILE__, __LINE__)
+
+//NOTE: Fails the running test unless the statement throws a std::exception.
+#define HAPPAH_CHECK_THROWS(statement) ::happah::check_throws([&]() { statement; }, #statement, __FILE__, __LINE__)
+
+namespace happah {
+
+//DECLARATIONS
+
+using Test = std::pair<std::string, std::function<void()> >;//name and body
+
+inline void check(bool condition, const char* text, const char* file, int line);
+
+template<class Statement>
+void check_throws(Statement statement, const char* text, const char* file, int line);
+
+//NOTE: Runs every test, reports the failed ones and returns the exit status of the test program.
+inline int run_tests(const std::vector<Test>& tests);
+
+//DEFINITIONS
+
+//NOTE: Removes the file when the test that made it ends.
+class TemporaryFile {
+public:
+     TemporaryFile(std::string path)
+          : m_path(std::move(path)) {}
+
+     TemporaryFile(const TemporaryFile& file) = delete;
+
+     ~TemporaryFile() {
+          std::remove(m_path.c_str());
+          std::remove((m_path + ".cache").c_str());
+     }
+
+     TemporaryFile& operator=(const TemporaryFile& file) = delete;
+
+     const std::string& getPath() const { return m_path; }
+
+private:
+     std::string m_path;
+
+};//TemporaryFile
+
+inline void check(bool condition, const char* text, const char* file, int line) { if(!condition) throw std::runtime_error(std::string(file) + ':' + std::to_string(line) + ": " + text); }
+
+template<class Statement>
+void check_throws(Statement statement, const char* text, const char* file, int line) {
+     try {
+          statement();
+     } catch(std::exception&) {
+          return;
+     }
+     throw std::runtime_error(std::string(file) + ':' + std::to_string(line) + ": " + text + " did not throw.");
+}
+
+inline int run_tests(const std::vector<Test>& tests) {
+     auto nFailed = 0;
+     for(auto& test : tests) {
+          try {
+               test.second();
+          } catch(std::exception& e) {
+               std::cerr << "ERROR: " << test.first << " failed: " << e.what() << std::endl;
+               ++nFailed;
+          }
+     }
+     std::cout << "INFO: " << tests.size() - nFailed << " of " << tests.size() << " tests passed." << std::endl;
+     return (nFailed) ? 1 : 0;
+}
+
+}//namespace happah
+